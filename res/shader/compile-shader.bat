@@ -1,2 +1,2 @@
-for /r %%i in (*.frag, *.vert) do %VULKAN_SDK%/Bin/glslangValidator.exe -o %%i.spv -V %%i
+for /r %%i in (*.frag, *.vert, *.comp) do %VULKAN_SDK%/Bin/glslangValidator.exe -o %%i.spv -V %%i
 pause
\ No newline at end of file
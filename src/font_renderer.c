@@ -3,6 +3,7 @@
 #include "ignis/pipeline.h"
 #include "ignis/buffer.h"
 #include "ignis/texture.h"
+#include "ignis/frame_allocator.h"
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -10,8 +11,7 @@
 
 static struct IgnisFontRendererStorage
 {
-    IgnisBuffer vertexBuffer;
-    IgnisBuffer indexBuffer;
+    IgnisDynamicBuffer indexBuffer;
     IgnisPipeline pipeline;
 
     IgnisFont* font;
@@ -39,26 +39,24 @@ void ignisGenerateQuadIndices(uint32_t* indices, size_t max)
 
 uint8_t ignisFontRendererInit()
 {
+    // vertices are copied to the frame allocator on flush
     size_t size = IGNIS_FONTRENDERER_MAX_QUADS * IGNIS_FONTRENDERER_QUAD_SIZE * sizeof(float);
-    if (!ignisCreateBuffer(NULL, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &render_data.vertexBuffer))
+    render_data.vertices = ignisAlloc(size);
+    if (!render_data.vertices)
     {
-        IGNIS_ERROR("failed to create vertex buffer");
+        IGNIS_ERROR("failed to allocate vertices");
         return IGNIS_FAIL;
     }
 
-    vkMapMemory(ignisGetVkDevice(), render_data.vertexBuffer.memory, 0, size, 0, &render_data.vertices);
-
     size = IGNIS_FONTRENDERER_MAX_QUADS * IGNIS_INDICES_PER_QUAD * sizeof(uint32_t);
-    if (!ignisCreateBuffer(NULL, size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &render_data.indexBuffer))
+    if (!ignisCreateDynamicBuffer(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &render_data.indexBuffer))
     {
         IGNIS_ERROR("failed to create index buffer");
         return IGNIS_FAIL;
     }
 
-    uint32_t* indices;
-    vkMapMemory(ignisGetVkDevice(), render_data.indexBuffer.memory, 0, size, 0, &indices);
-    ignisGenerateQuadIndices(indices, IGNIS_FONTRENDERER_MAX_QUADS * IGNIS_INDICES_PER_QUAD);
-    vkUnmapMemory(ignisGetVkDevice(), render_data.indexBuffer.memory);
+    ignisGenerateQuadIndices(render_data.indexBuffer.data, IGNIS_FONTRENDERER_MAX_QUADS * IGNIS_INDICES_PER_QUAD);
+    ignisFlushDynamicBuffer(&render_data.indexBuffer, 0, size);
 
     render_data.quad_count = 0;
 
@@ -78,8 +76,6 @@ uint8_t ignisFontRendererInit()
         .attributeCount = attributeCount,
         .vertexStride = vertexStride,
         .uniformBufferSize = uniformBufferSize,
-        .cullMode = VK_CULL_MODE_BACK_BIT,
-        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
     };
 
     VkShaderModule vertShader = ignisCreateShaderModule("./res/shader/font.vert.spv");
@@ -99,8 +95,8 @@ uint8_t ignisFontRendererInit()
 
 void ignisFontRendererDestroy()
 {
-    ignisDestroyBuffer(&render_data.vertexBuffer);
-    ignisDestroyBuffer(&render_data.indexBuffer);
+    ignisFree(render_data.vertices, IGNIS_FONTRENDERER_MAX_QUADS * IGNIS_FONTRENDERER_QUAD_SIZE * sizeof(float));
+    ignisDestroyDynamicBuffer(&render_data.indexBuffer);
 
     ignisDestroyPipeline(&render_data.pipeline);
 }
@@ -117,15 +113,26 @@ void ignisFontRendererSetProjection(const float* proj)
 
 void ignisFontRendererStart(VkCommandBuffer commandBuffer)
 {
-    ignisBindPipeline(commandBuffer, &render_data.pipeline);
     ignisBindTexture(&render_data.pipeline, render_data.font->texture, 1);
+    ignisBindPipeline(commandBuffer, &render_data.pipeline);
 }
 
 void ignisFontRendererFlush(VkCommandBuffer commandBuffer)
 {
     if (render_data.quad_count == 0) return;
 
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &render_data.vertexBuffer.handle, (VkDeviceSize[]) { 0 });
+    size_t size = render_data.quad_count * IGNIS_FONTRENDERER_QUAD_SIZE * sizeof(float);
+
+    IgnisFrameAllocation vertices;
+    if (!ignisFrameAllocate(size, sizeof(float), &vertices))
+    {
+        render_data.quad_count = 0;
+        return;
+    }
+
+    memcpy(vertices.data, render_data.vertices, size);
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertices.buffer, &vertices.offset);
 
     vkCmdBindIndexBuffer(commandBuffer, render_data.indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
     vkCmdDrawIndexed(commandBuffer, IGNIS_INDICES_PER_QUAD * render_data.quad_count, 1, 0, 0, 0);
@@ -0,0 +1,409 @@
+#include "allocator.h"
+
+typedef struct
+{
+    VkDeviceSize offset;
+    VkDeviceSize size;
+} IgnisMemoryRange;
+
+struct IgnisMemoryBlock
+{
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    void* data;
+
+    uint32_t memoryType;
+    uint32_t allocationCount;
+    uint8_t dedicated;
+
+    /* free ranges sorted by offset */
+    IgnisMemoryRange* ranges;
+    uint32_t rangeCount;
+    uint32_t rangeCapacity;
+
+    IgnisMemoryBlock* next;
+};
+
+static VkDeviceSize ignisAlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/* ---------------------------------| block |------------------------------------------- */
+static uint8_t ignisBlockReserve(IgnisMemoryBlock* block, uint32_t capacity)
+{
+    if (capacity <= block->rangeCapacity) return IGNIS_OK;
+
+    uint32_t newCapacity = block->rangeCapacity ? block->rangeCapacity * 2 : 8;
+    while (newCapacity < capacity) newCapacity *= 2;
+
+    IgnisMemoryRange* ranges = ignisAlloc(newCapacity * sizeof(IgnisMemoryRange));
+    if (!ranges) return IGNIS_FAIL;
+
+    if (block->ranges)
+    {
+        memcpy(ranges, block->ranges, block->rangeCount * sizeof(IgnisMemoryRange));
+        ignisFree(block->ranges, block->rangeCapacity * sizeof(IgnisMemoryRange));
+    }
+
+    block->ranges = ranges;
+    block->rangeCapacity = newCapacity;
+    return IGNIS_OK;
+}
+
+static void ignisBlockInsertRange(IgnisMemoryBlock* block, uint32_t index, VkDeviceSize offset, VkDeviceSize size)
+{
+    memmove(block->ranges + index + 1, block->ranges + index, (block->rangeCount - index) * sizeof(IgnisMemoryRange));
+    block->ranges[index] = (IgnisMemoryRange){ offset, size };
+    block->rangeCount++;
+}
+
+static void ignisBlockRemoveRange(IgnisMemoryBlock* block, uint32_t index)
+{
+    memmove(block->ranges + index, block->ranges + index + 1, (block->rangeCount - index - 1) * sizeof(IgnisMemoryRange));
+    block->rangeCount--;
+}
+
+static uint8_t ignisBlockAllocate(IgnisMemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset)
+{
+    /*
+     * free ranges are separated by allocations, so there can never be more
+     * than allocationCount + 1 of them. Reserving for the worst case here
+     * guarantees that freeing never has to allocate.
+     */
+    if (!ignisBlockReserve(block, block->allocationCount + 2))
+        return IGNIS_FAIL;
+
+    for (uint32_t i = 0; i < block->rangeCount; ++i)
+    {
+        IgnisMemoryRange range = block->ranges[i];
+
+        VkDeviceSize aligned = ignisAlignUp(range.offset, alignment);
+        if (aligned + size > range.offset + range.size)
+            continue;
+
+        VkDeviceSize front = aligned - range.offset;
+        VkDeviceSize back = (range.offset + range.size) - (aligned + size);
+
+        if (front > 0)
+        {
+            block->ranges[i].size = front;
+            if (back > 0) ignisBlockInsertRange(block, i + 1, aligned + size, back);
+        }
+        else if (back > 0)
+        {
+            block->ranges[i].offset = aligned + size;
+            block->ranges[i].size = back;
+        }
+        else
+        {
+            ignisBlockRemoveRange(block, i);
+        }
+
+        block->allocationCount++;
+        *offset = aligned;
+        return IGNIS_OK;
+    }
+
+    return IGNIS_FAIL;
+}
+
+static void ignisBlockFree(IgnisMemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+{
+    uint32_t i = 0;
+    while (i < block->rangeCount && block->ranges[i].offset < offset) ++i;
+
+    uint8_t mergePrev = i > 0 && block->ranges[i - 1].offset + block->ranges[i - 1].size == offset;
+    uint8_t mergeNext = i < block->rangeCount && offset + size == block->ranges[i].offset;
+
+    if (mergePrev && mergeNext)
+    {
+        block->ranges[i - 1].size += size + block->ranges[i].size;
+        ignisBlockRemoveRange(block, i);
+    }
+    else if (mergePrev)
+    {
+        block->ranges[i - 1].size += size;
+    }
+    else if (mergeNext)
+    {
+        block->ranges[i].offset = offset;
+        block->ranges[i].size += size;
+    }
+    else
+    {
+        ignisBlockInsertRange(block, i, offset, size);
+    }
+
+    block->allocationCount--;
+}
+
+static IgnisMemoryBlock* ignisCreateMemoryBlock(IgnisAllocator* allocator, uint32_t memoryType, VkDeviceSize size, uint8_t dedicated)
+{
+    IgnisMemoryBlock* block = ignisAlloc(sizeof(IgnisMemoryBlock));
+    if (!block) return NULL;
+
+    memset(block, 0, sizeof(IgnisMemoryBlock));
+
+    VkMemoryAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memoryType
+    };
+
+    if (vkAllocateMemory(allocator->device, &allocInfo, allocator->callbacks, &block->memory) != VK_SUCCESS)
+    {
+        ignisFree(block, sizeof(IgnisMemoryBlock));
+        return NULL;
+    }
+
+    /* host visible blocks are mapped once for their whole lifetime */
+    VkMemoryPropertyFlags flags = allocator->properties.memoryTypes[memoryType].propertyFlags;
+    if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(allocator->device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->data) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to map memory block!");
+            vkFreeMemory(allocator->device, block->memory, allocator->callbacks);
+            ignisFree(block, sizeof(IgnisMemoryBlock));
+            return NULL;
+        }
+    }
+
+    block->size = size;
+    block->memoryType = memoryType;
+    block->dedicated = dedicated;
+
+    if (!ignisBlockReserve(block, 8))
+    {
+        vkFreeMemory(allocator->device, block->memory, allocator->callbacks);
+        ignisFree(block, sizeof(IgnisMemoryBlock));
+        return NULL;
+    }
+
+    block->ranges[0] = (IgnisMemoryRange){ 0, size };
+    block->rangeCount = 1;
+
+    IgnisMemoryHeapStats* stats = &allocator->heapStats[allocator->properties.memoryTypes[memoryType].heapIndex];
+    stats->blockBytes += size;
+    stats->blockCount++;
+
+    return block;
+}
+
+static void ignisDestroyMemoryBlock(IgnisAllocator* allocator, IgnisMemoryBlock* block)
+{
+    IgnisMemoryHeapStats* stats = &allocator->heapStats[allocator->properties.memoryTypes[block->memoryType].heapIndex];
+    stats->blockBytes -= block->size;
+    stats->blockCount--;
+
+    vkFreeMemory(allocator->device, block->memory, allocator->callbacks);
+
+    ignisFree(block->ranges, block->rangeCapacity * sizeof(IgnisMemoryRange));
+    ignisFree(block, sizeof(IgnisMemoryBlock));
+}
+
+/* ---------------------------------| allocator |--------------------------------------- */
+uint8_t ignisCreateAllocator(VkDevice device, VkPhysicalDevice physical, const VkAllocationCallbacks* callbacks, IgnisAllocator* allocator)
+{
+    memset(allocator, 0, sizeof(IgnisAllocator));
+
+    allocator->device = device;
+    allocator->callbacks = callbacks;
+
+    vkGetPhysicalDeviceMemoryProperties(physical, &allocator->properties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical, &properties);
+
+    allocator->nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyAllocator(IgnisAllocator* allocator)
+{
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i)
+    {
+        for (uint32_t j = 0; j < IGNIS_ALLOCATION_TYPE_MAX_ENUM; ++j)
+        {
+            IgnisMemoryBlock* block = allocator->blocks[i][j];
+            while (block)
+            {
+                IgnisMemoryBlock* next = block->next;
+
+                if (block->allocationCount)
+                    IGNIS_WARN("destroying memory block with %u live allocation(s)", block->allocationCount);
+
+                ignisDestroyMemoryBlock(allocator, block);
+                block = next;
+            }
+            allocator->blocks[i][j] = NULL;
+        }
+    }
+}
+
+static VkDeviceSize ignisGetBlockSize(const IgnisAllocator* allocator, uint32_t memoryType)
+{
+    /* keep small heaps (e.g. the BAR window) from being eaten up by a few blocks */
+    uint32_t heap = allocator->properties.memoryTypes[memoryType].heapIndex;
+    VkDeviceSize heapSize = allocator->properties.memoryHeaps[heap].size;
+
+    return heapSize / 8 < IGNIS_MEMORY_BLOCK_SIZE ? heapSize / 8 : IGNIS_MEMORY_BLOCK_SIZE;
+}
+
+static uint8_t ignisAllocateFromType(IgnisAllocator* allocator, uint32_t memoryType, VkDeviceSize size, VkDeviceSize alignment, IgnisAllocationType type, IgnisAllocation* allocation)
+{
+    /* keep non coherent allocations flushable without touching their neighbours */
+    VkMemoryPropertyFlags flags = allocator->properties.memoryTypes[memoryType].propertyFlags;
+    if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        if (alignment < allocator->nonCoherentAtomSize) alignment = allocator->nonCoherentAtomSize;
+        size = ignisAlignUp(size, allocator->nonCoherentAtomSize);
+    }
+
+    IgnisMemoryBlock** list = &allocator->blocks[memoryType][type];
+    IgnisMemoryBlock* block = NULL;
+    VkDeviceSize offset = 0;
+
+    VkDeviceSize blockSize = ignisGetBlockSize(allocator, memoryType);
+    if (size > blockSize / 2)
+    {
+        /* large resources get a block of their own */
+        block = ignisCreateMemoryBlock(allocator, memoryType, size, 1);
+        if (!block) return IGNIS_FAIL;
+
+        if (!ignisBlockAllocate(block, size, alignment, &offset))
+        {
+            ignisDestroyMemoryBlock(allocator, block);
+            return IGNIS_FAIL;
+        }
+
+        block->next = *list;
+        *list = block;
+    }
+    else
+    {
+        for (block = *list; block; block = block->next)
+        {
+            if (!block->dedicated && ignisBlockAllocate(block, size, alignment, &offset))
+                break;
+        }
+
+        if (!block)
+        {
+            block = ignisCreateMemoryBlock(allocator, memoryType, blockSize, 0);
+            if (!block) return IGNIS_FAIL;
+
+            if (!ignisBlockAllocate(block, size, alignment, &offset))
+            {
+                ignisDestroyMemoryBlock(allocator, block);
+                return IGNIS_FAIL;
+            }
+
+            block->next = *list;
+            *list = block;
+        }
+    }
+
+    allocation->memory = block->memory;
+    allocation->offset = offset;
+    allocation->size = size;
+    allocation->data = block->data ? (char*)block->data + offset : NULL;
+    allocation->properties = flags;
+    allocation->block = block;
+
+    IgnisMemoryHeapStats* stats = &allocator->heapStats[allocator->properties.memoryTypes[memoryType].heapIndex];
+    stats->usedBytes += size;
+    stats->allocationCount++;
+
+    return IGNIS_OK;
+}
+
+static uint8_t ignisAllocateWithProperties(IgnisAllocator* allocator, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, IgnisAllocationType type, IgnisAllocation* allocation)
+{
+    for (uint32_t i = 0; i < allocator->properties.memoryTypeCount; ++i)
+    {
+        if (!(requirements.memoryTypeBits & (1 << i)))
+            continue;
+
+        if ((allocator->properties.memoryTypes[i].propertyFlags & properties) != properties)
+            continue;
+
+        /* try the next suitable type if this heap is exhausted */
+        if (ignisAllocateFromType(allocator, i, requirements.size, requirements.alignment, type, allocation))
+            return IGNIS_OK;
+    }
+
+    return IGNIS_FAIL;
+}
+
+uint8_t ignisAllocatorAlloc(IgnisAllocator* allocator, VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocationType type, IgnisAllocation* allocation)
+{
+    if (preferred & ~required)
+    {
+        if (ignisAllocateWithProperties(allocator, requirements, required | preferred, type, allocation))
+            return IGNIS_OK;
+    }
+
+    if (ignisAllocateWithProperties(allocator, requirements, required, type, allocation))
+        return IGNIS_OK;
+
+    IGNIS_ERROR("failed to find suitable memory type!");
+    memset(allocation, 0, sizeof(IgnisAllocation));
+    return IGNIS_FAIL;
+}
+
+uint8_t ignisAllocatorFlush(IgnisAllocator* allocator, const IgnisAllocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    if (allocation->properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        return IGNIS_OK;
+
+    /* non coherent allocations are atom aligned, so the rounded range stays inside */
+    VkDeviceSize atom = allocator->nonCoherentAtomSize;
+    VkDeviceSize begin = (offset / atom) * atom;
+    VkDeviceSize end = ignisAlignUp(offset + size, atom);
+    if (end > allocation->size) end = allocation->size;
+
+    VkMappedMemoryRange range = {
+        .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+        .memory = allocation->memory,
+        .offset = allocation->offset + begin,
+        .size = end - begin
+    };
+
+    return vkFlushMappedMemoryRanges(allocator->device, 1, &range) == VK_SUCCESS;
+}
+
+void ignisAllocatorFree(IgnisAllocator* allocator, IgnisAllocation* allocation)
+{
+    IgnisMemoryBlock* block = allocation->block;
+    if (!block) return;
+
+    ignisBlockFree(block, allocation->offset, allocation->size);
+
+    IgnisMemoryHeapStats* stats = &allocator->heapStats[allocator->properties.memoryTypes[block->memoryType].heapIndex];
+    stats->usedBytes -= allocation->size;
+    stats->allocationCount--;
+
+    memset(allocation, 0, sizeof(IgnisAllocation));
+
+    if (block->allocationCount > 0) return;
+
+    /* release empty blocks, but keep one shared block per list around */
+    for (uint32_t i = 0; i < IGNIS_ALLOCATION_TYPE_MAX_ENUM; ++i)
+    {
+        IgnisMemoryBlock** link = &allocator->blocks[block->memoryType][i];
+        while (*link && *link != block) link = &(*link)->next;
+
+        if (!*link) continue;
+
+        uint8_t onlyBlock = *link == allocator->blocks[block->memoryType][i] && !block->next;
+        if (block->dedicated || !onlyBlock)
+        {
+            *link = block->next;
+            ignisDestroyMemoryBlock(allocator, block);
+        }
+        return;
+    }
+}
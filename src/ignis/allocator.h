@@ -0,0 +1,66 @@
+#ifndef IGNIS_ALLOCATOR_H
+#define IGNIS_ALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+
+#include "common.h"
+
+#define IGNIS_MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+
+/*
+ * Linear and optimal resources are never placed in the same block,
+ * so neighbouring allocations can not violate bufferImageGranularity.
+ */
+typedef enum
+{
+    IGNIS_ALLOCATION_LINEAR,    /* buffers */
+    IGNIS_ALLOCATION_OPTIMAL,   /* optimal tiled images */
+    IGNIS_ALLOCATION_TYPE_MAX_ENUM
+} IgnisAllocationType;
+
+typedef struct IgnisMemoryBlock IgnisMemoryBlock;
+
+typedef struct
+{
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+
+    void* data; /* persistently mapped pointer, only set for host visible memory */
+    VkMemoryPropertyFlags properties;
+
+    IgnisMemoryBlock* block;
+} IgnisAllocation;
+
+typedef struct
+{
+    VkDeviceSize blockBytes;    /* memory allocated from the driver */
+    VkDeviceSize usedBytes;     /* memory handed out to resources */
+
+    uint32_t blockCount;
+    uint32_t allocationCount;
+} IgnisMemoryHeapStats;
+
+typedef struct
+{
+    VkDevice device;
+    const VkAllocationCallbacks* callbacks;
+
+    VkPhysicalDeviceMemoryProperties properties;
+    VkDeviceSize nonCoherentAtomSize;
+
+    IgnisMemoryBlock* blocks[VK_MAX_MEMORY_TYPES][IGNIS_ALLOCATION_TYPE_MAX_ENUM];
+    IgnisMemoryHeapStats heapStats[VK_MAX_MEMORY_HEAPS];
+} IgnisAllocator;
+
+uint8_t ignisCreateAllocator(VkDevice device, VkPhysicalDevice physical, const VkAllocationCallbacks* callbacks, IgnisAllocator* allocator);
+void ignisDestroyAllocator(IgnisAllocator* allocator);
+
+/* memory types with all preferred properties are tried first */
+uint8_t ignisAllocatorAlloc(IgnisAllocator* allocator, VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocationType type, IgnisAllocation* allocation);
+void ignisAllocatorFree(IgnisAllocator* allocator, IgnisAllocation* allocation);
+
+/* make host writes to non coherent memory visible, no-op for coherent memory */
+uint8_t ignisAllocatorFlush(IgnisAllocator* allocator, const IgnisAllocation* allocation, VkDeviceSize offset, VkDeviceSize size);
+
+#endif /* !IGNIS_ALLOCATOR_H */
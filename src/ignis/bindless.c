@@ -0,0 +1,199 @@
+#include "bindless.h"
+
+enum
+{
+    IGNIS_BINDLESS_TEXTURE_BINDING,
+    IGNIS_BINDLESS_SAMPLER_BINDING
+};
+
+static struct IgnisBindlessTable
+{
+    VkDescriptorSetLayout layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+
+    uint32_t capacity;
+    uint32_t count;     /* slots handed out so far */
+
+    /* released slots */
+    uint32_t* freeIndices;
+    uint32_t freeCount;
+} bindless;
+
+static uint32_t ignisMin32(uint32_t a, uint32_t b) { return a < b ? a : b; }
+
+uint8_t ignisCreateBindlessTable()
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    /* clamp to the device limits */
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES
+    };
+
+    VkPhysicalDeviceProperties2 properties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &indexingProperties
+    };
+    vkGetPhysicalDeviceProperties2(ignisGetVkPhysicalDevice(), &properties);
+
+    uint32_t capacity = IGNIS_BINDLESS_MAX_TEXTURES;
+    capacity = ignisMin32(capacity, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+    capacity = ignisMin32(capacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    capacity = ignisMin32(capacity, indexingProperties.maxDescriptorSetUpdateAfterBindSamplers);
+    capacity = ignisMin32(capacity, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers);
+
+    memset(&bindless, 0, sizeof(bindless));
+    bindless.capacity = capacity;
+
+    bindless.freeIndices = ignisAlloc(capacity * sizeof(uint32_t));
+    if (!bindless.freeIndices)
+        return IGNIS_FAIL;
+
+    /* layout */
+    VkDescriptorSetLayoutBinding bindings[] = {
+        {
+            .binding = IGNIS_BINDLESS_TEXTURE_BINDING,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL
+        },
+        {
+            .binding = IGNIS_BINDLESS_SAMPLER_BINDING,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .descriptorCount = capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL
+        }
+    };
+
+    // new slots are written while frames in flight still use the set
+    VkDescriptorBindingFlags bindingFlags[] = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = sizeof(bindingFlags) / sizeof(bindingFlags[0]),
+        .pBindingFlags = bindingFlags
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = sizeof(bindings) / sizeof(bindings[0]),
+        .pBindings = bindings,
+        .pNext = &bindingFlagsInfo
+    };
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, allocator, &bindless.layout) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create bindless descriptor set layout!");
+        return IGNIS_FAIL;
+    }
+
+    /* pool */
+    VkDescriptorPoolSize poolSizes[] = {
+        { .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = capacity },
+        { .type = VK_DESCRIPTOR_TYPE_SAMPLER,       .descriptorCount = capacity }
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .poolSizeCount = sizeof(poolSizes) / sizeof(poolSizes[0]),
+        .pPoolSizes = poolSizes,
+        .maxSets = 1
+    };
+
+    if (vkCreateDescriptorPool(device, &poolInfo, allocator, &bindless.pool) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create bindless descriptor pool!");
+        return IGNIS_FAIL;
+    }
+
+    /* set */
+    VkDescriptorSetAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = bindless.pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &bindless.layout
+    };
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &bindless.set) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to allocate bindless descriptor set!");
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyBindlessTable()
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    vkDestroyDescriptorPool(device, bindless.pool, allocator);
+    vkDestroyDescriptorSetLayout(device, bindless.layout, allocator);
+
+    ignisFree(bindless.freeIndices, bindless.capacity * sizeof(uint32_t));
+}
+
+uint32_t ignisBindlessAddTexture(VkImageView view, VkSampler sampler)
+{
+    uint32_t index = IGNIS_BINDLESS_INVALID_INDEX;
+    if (bindless.freeCount)         index = bindless.freeIndices[--bindless.freeCount];
+    else if (bindless.count < bindless.capacity) index = bindless.count++;
+
+    if (index == IGNIS_BINDLESS_INVALID_INDEX)
+    {
+        IGNIS_WARN("bindless texture table is full");
+        return IGNIS_BINDLESS_INVALID_INDEX;
+    }
+
+    VkDescriptorImageInfo imageInfo = {
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        .imageView = view
+    };
+
+    VkDescriptorImageInfo samplerInfo = {
+        .sampler = sampler
+    };
+
+    VkWriteDescriptorSet writes[] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = bindless.set,
+            .dstBinding = IGNIS_BINDLESS_TEXTURE_BINDING,
+            .dstArrayElement = index,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = 1,
+            .pImageInfo = &imageInfo
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = bindless.set,
+            .dstBinding = IGNIS_BINDLESS_SAMPLER_BINDING,
+            .dstArrayElement = index,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .descriptorCount = 1,
+            .pImageInfo = &samplerInfo
+        }
+    };
+
+    vkUpdateDescriptorSets(ignisGetVkDevice(), 2, writes, 0, NULL);
+
+    return index;
+}
+
+void ignisBindlessRemoveTexture(uint32_t index)
+{
+    // partially bound slots may keep a stale descriptor as long as no shader reads them
+    if (index < bindless.count)
+        bindless.freeIndices[bindless.freeCount++] = index;
+}
+
+VkDescriptorSetLayout ignisGetBindlessSetLayout() { return bindless.layout; }
+VkDescriptorSet       ignisGetBindlessSet()       { return bindless.set; }
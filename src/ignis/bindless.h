@@ -0,0 +1,32 @@
+#ifndef IGNIS_BINDLESS_H
+#define IGNIS_BINDLESS_H
+
+#include "ignis_core.h"
+
+/*
+ * Global texture table, bound as set 1 of every pipeline. Textures are
+ * registered once at creation and addressed by their index in shaders:
+ *
+ *   layout(set = 1, binding = 0) uniform texture2D textures[];
+ *   layout(set = 1, binding = 1) uniform sampler samplers[];
+ *
+ *   texture(sampler2D(textures[nonuniformEXT(i)], samplers[nonuniformEXT(i)]), uv);
+ *
+ * The arrays are partially bound and update after bind, so registering
+ * a texture never invalidates recorded command buffers.
+ */
+#define IGNIS_BINDLESS_MAX_TEXTURES     1024
+#define IGNIS_BINDLESS_INVALID_INDEX    UINT32_MAX
+
+#define IGNIS_BINDLESS_SET              1
+
+uint8_t ignisCreateBindlessTable();
+void ignisDestroyBindlessTable();
+
+uint32_t ignisBindlessAddTexture(VkImageView view, VkSampler sampler);
+void ignisBindlessRemoveTexture(uint32_t index);
+
+VkDescriptorSetLayout ignisGetBindlessSetLayout();
+VkDescriptorSet       ignisGetBindlessSet();
+
+#endif /* !IGNIS_BINDLESS_H */
@@ -1,22 +1,11 @@
 #include "buffer.h"
 
-#include "ignis.h"
-
-
-static void ignisCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
-{
-    VkCommandBuffer commandBuffer = ignisBeginOneTimeCommandBuffer();
-
-    VkBufferCopy copyRegion = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = size
-    };
+#include <stddef.h>
 
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+#include "ignis.h"
+#include "upload.h"
+#include "deletion_queue.h"
 
-    ignisEndOneTimeCommandBuffer(commandBuffer);
-}
 
 uint8_t ignisCreateBuffer(const void* data, size_t size, VkBufferUsageFlags usage, IgnisBuffer* buffer)
 {
@@ -36,19 +25,13 @@ uint8_t ignisCreateBuffer(const void* data, size_t size, VkBufferUsageFlags usag
         return IGNIS_FAIL;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer->handle, &memRequirements);
-
     VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    buffer->memory = ignisAllocateDeviceMemory(memRequirements, properties, allocator);
-    if (!buffer->memory)
+    if (!ignisAllocateBufferMemory(buffer->handle, properties, 0, &buffer->allocation))
     {
         IGNIS_ERROR("failed to find allocate device memory!");
         return IGNIS_FAIL;
     }
 
-    vkBindBufferMemory(device, buffer->handle, buffer->memory, 0);
-
     if (!data) return IGNIS_OK;
 
     return ignisWriteBuffer(data, size, buffer);
@@ -72,48 +55,155 @@ uint8_t ignisCreateBufferStaged(const void* data, size_t size, VkBufferUsageFlag
         return IGNIS_FAIL;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(device, buffer->handle, &memRequirements);
-
     VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    buffer->memory = ignisAllocateDeviceMemory(memRequirements, properties, allocator);
-    if (!buffer->memory)
+    if (!ignisAllocateBufferMemory(buffer->handle, properties, 0, &buffer->allocation))
     {
         IGNIS_ERROR("failed to find allocate device memory!");
         return IGNIS_FAIL;
     }
 
-    vkBindBufferMemory(device, buffer->handle, buffer->memory, 0);
-
-    IgnisBuffer stagingBuffer;
-    ignisCreateBuffer(data, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &stagingBuffer);
+    if (!data) return IGNIS_OK;
 
-    ignisCopyBuffer(stagingBuffer.handle, buffer->handle, size);
+    IgnisUploadTicket ticket = ignisUploadBuffer(buffer, 0, data, size);
+    if (!ticket)
+    {
+        IGNIS_ERROR("failed to upload buffer data!");
+        return IGNIS_FAIL;
+    }
 
-    ignisDestroyBuffer(&stagingBuffer);
+    // batched uploads are waited for by the owner of the batch
+    if (!ignisUploadBatching())
+        ignisWaitUpload(ticket);
 
     return IGNIS_OK;
 }
 
 void ignisDestroyBuffer(IgnisBuffer* buffer)
 {
-    VkDevice device = ignisGetVkDevice();
-    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+    ignisDeferDeletion(IGNIS_DELETE_BUFFER, (IgnisDeletionHandle){ .buffer = buffer->handle });
+    ignisDeferDeletion(IGNIS_DELETE_MEMORY, (IgnisDeletionHandle){ .allocation = buffer->allocation });
+}
+
+void ignisPackInstances(IgnisInstance* instances, const float* transforms, const float* colors, uint32_t count)
+{
+    static const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        memcpy(instances[i].transform, transforms + i * 16, sizeof(instances[i].transform));
+        memcpy(instances[i].color, colors ? colors + i * 4 : white, sizeof(instances[i].color));
+    }
+}
+
+uint8_t ignisCreateInstanceBuffer(const float* transforms, const float* colors, uint32_t count, IgnisBuffer* buffer)
+{
+    size_t size = count * sizeof(IgnisInstance);
+
+    IgnisInstance* instances = ignisAlloc(size);
+    if (!instances) return IGNIS_FAIL;
+
+    ignisPackInstances(instances, transforms, colors, count);
+
+    uint8_t result = ignisCreateBufferStaged(instances, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, buffer);
+
+    ignisFree(instances, size);
+
+    return result;
+}
+
+VkVertexInputBindingDescription ignisGetInstanceBinding(uint32_t binding)
+{
+    return (VkVertexInputBindingDescription){
+        .binding = binding,
+        .stride = sizeof(IgnisInstance),
+        .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+    };
+}
+
+void ignisGetInstanceAttributes(uint32_t binding, uint32_t location, VkVertexInputAttributeDescription* attributes)
+{
+    /* a mat4 takes one location per column */
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        attributes[i] = (VkVertexInputAttributeDescription){
+            .location = location + i,
+            .binding = binding,
+            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .offset = offsetof(IgnisInstance, transform) + i * 4 * sizeof(float)
+        };
+    }
 
-    vkDestroyBuffer(device, buffer->handle, allocator);
-    vkFreeMemory(device, buffer->memory, allocator);
+    attributes[4] = (VkVertexInputAttributeDescription){
+        .location = location + 4,
+        .binding = binding,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(IgnisInstance, color)
+    };
 }
 
 uint8_t ignisWriteBuffer(const void* data, size_t size, IgnisBuffer* buffer)
+{
+    if (!buffer->allocation.data || size > buffer->allocation.size)
+        return IGNIS_FAIL;
+
+    memcpy(buffer->allocation.data, data, size);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisCreateDynamicBuffer(VkDeviceSize size, VkBufferUsageFlags usage, IgnisDynamicBuffer* buffer)
 {
     VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
-    void* mapped;
-    vkMapMemory(device, buffer->memory, 0, size, 0, &mapped);
+    VkBufferCreateInfo bufferInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    if (vkCreateBuffer(device, &bufferInfo, allocator, &buffer->handle) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create buffer handle!");
+        return IGNIS_FAIL;
+    }
 
-    memcpy(mapped, data, size);
+    VkMemoryPropertyFlags required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    VkMemoryPropertyFlags preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    if (!ignisAllocateBufferMemory(buffer->handle, required, preferred, &buffer->allocation))
+    {
+        IGNIS_ERROR("failed to find allocate device memory!");
+        vkDestroyBuffer(device, buffer->handle, allocator);
+        return IGNIS_FAIL;
+    }
 
-    vkUnmapMemory(device, buffer->memory);
+    buffer->data = buffer->allocation.data;
+    buffer->size = size;
 
     return IGNIS_OK;
-}
\ No newline at end of file
+}
+
+void ignisDestroyDynamicBuffer(IgnisDynamicBuffer* buffer)
+{
+    ignisDeferDeletion(IGNIS_DELETE_BUFFER, (IgnisDeletionHandle){ .buffer = buffer->handle });
+    ignisDeferDeletion(IGNIS_DELETE_MEMORY, (IgnisDeletionHandle){ .allocation = buffer->allocation });
+
+    buffer->data = NULL;
+    buffer->size = 0;
+}
+
+uint8_t ignisWriteDynamicBuffer(IgnisDynamicBuffer* buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    if (offset + size > buffer->size)
+        return IGNIS_FAIL;
+
+    memcpy((char*)buffer->data + offset, data, size);
+
+    return ignisFlushDynamicBuffer(buffer, offset, size);
+}
+
+uint8_t ignisFlushDynamicBuffer(IgnisDynamicBuffer* buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    return ignisFlushDeviceMemory(&buffer->allocation, offset, size);
+}
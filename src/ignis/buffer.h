@@ -6,7 +6,7 @@
 typedef struct
 {
     VkBuffer handle;
-    VkDeviceMemory memory;
+    IgnisAllocation allocation;
 } IgnisBuffer;
 
 uint8_t ignisCreateBuffer(const void* data, size_t size, VkBufferUsageFlags usage, IgnisBuffer* buffer);
@@ -18,8 +18,50 @@ uint8_t ignisCreateBufferStaged(const void* data, size_t size, VkBufferUsageFlag
 #define ignisCreateIndexBuffer(indices, count, buffer) \
     ignisCreateBufferStaged(indices, count * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, buffer)
 
+/* deleted once the frames in flight are done with it, see deletion_queue.h */
 void ignisDestroyBuffer(IgnisBuffer* buffer);
 
+/*
+ * Per instance stream for instanced draws. Each instance is a column major
+ * transform followed by a rgba color, read as 5 vec4 attributes.
+ */
+typedef struct
+{
+    float transform[16];
+    float color[4];
+} IgnisInstance;
+
+#define IGNIS_INSTANCE_ATTRIBUTE_COUNT 5
+
+/* colors may be NULL, instances are white then */
+void ignisPackInstances(IgnisInstance* instances, const float* transforms, const float* colors, uint32_t count);
+uint8_t ignisCreateInstanceBuffer(const float* transforms, const float* colors, uint32_t count, IgnisBuffer* buffer);
+
+VkVertexInputBindingDescription ignisGetInstanceBinding(uint32_t binding);
+void ignisGetInstanceAttributes(uint32_t binding, uint32_t location, VkVertexInputAttributeDescription* attributes);
+
 uint8_t ignisWriteBuffer(const void* data, size_t size, IgnisBuffer* buffer);
 
+/*
+ * Dynamic buffers are mapped once at creation and written by the cpu
+ * through data. Device local host visible memory (resizable bar) is
+ * preferred, so no staging copy is needed. Direct writes to data have
+ * to be flushed, in case the memory is not host coherent.
+ */
+typedef struct
+{
+    VkBuffer handle;
+    IgnisAllocation allocation;
+
+    void* data;
+    VkDeviceSize size;
+} IgnisDynamicBuffer;
+
+uint8_t ignisCreateDynamicBuffer(VkDeviceSize size, VkBufferUsageFlags usage, IgnisDynamicBuffer* buffer);
+void ignisDestroyDynamicBuffer(IgnisDynamicBuffer* buffer);
+
+/* copies data and flushes the written range */
+uint8_t ignisWriteDynamicBuffer(IgnisDynamicBuffer* buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+uint8_t ignisFlushDynamicBuffer(IgnisDynamicBuffer* buffer, VkDeviceSize offset, VkDeviceSize size);
+
 #endif /* !IGNIS_BUFFER_H */
\ No newline at end of file
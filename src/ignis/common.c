@@ -7,6 +7,21 @@
 void* ignisAlloc(size_t size) { return malloc(size); }
 void  ignisFree(void* block, size_t size)  { free(block); }
 
+uint8_t ignisReserve(void** block, uint32_t* capacity, uint32_t count, size_t elementSize)
+{
+    if (count <= *capacity) return IGNIS_OK;
+
+    uint32_t newCapacity = *capacity ? *capacity * 2 : 8;
+    while (newCapacity < count) newCapacity *= 2;
+
+    void* newBlock = realloc(*block, newCapacity * elementSize);
+    if (!newBlock) return IGNIS_FAIL;
+
+    *block = newBlock;
+    *capacity = newCapacity;
+    return IGNIS_OK;
+}
+
 char* ignisReadFile(const char* path, size_t* sizeptr)
 {
     FILE* file = fopen(path, "rb");
@@ -51,6 +66,20 @@ uint32_t ignisClamp32(uint32_t val, uint32_t min, uint32_t max)
     return t > max ? max : t;
 }
 
+uint64_t ignisHashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = data;
+
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
 // logging
 void _ignisLog(IgnisLogLevel level, const char* fmt, ...)
 {
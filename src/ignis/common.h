@@ -14,10 +14,18 @@
 void* ignisAlloc(size_t size);
 void  ignisFree(void* block, size_t size);
 
+/* grow a dynamic array so it can hold at least count elements */
+uint8_t ignisReserve(void** block, uint32_t* capacity, uint32_t count, size_t elementSize);
+
 char* ignisReadFile(const char* path, size_t* sizeptr);
 
 uint32_t ignisClamp32(uint32_t val, uint32_t min, uint32_t max);
 
+/* 64 bit FNV-1a, pass the previous hash as seed to hash several blocks */
+#define IGNIS_HASH_SEED 0xcbf29ce484222325ull
+
+uint64_t ignisHashBytes(const void* data, size_t size, uint64_t seed);
+
 /*
  * --------------------------------------------------------------
  *                          logging
@@ -0,0 +1,198 @@
+#include "culling.h"
+
+#include "upload.h"
+
+#include <math.h>
+
+typedef struct
+{
+    float planes[6][4];
+    uint32_t objectCount;
+    uint32_t compact;
+} IgnisCullConstants;
+
+/* planes of a column major view projection matrix, depth range is [0, 1] */
+static void ignisExtractFrustumPlanes(const float* m, float planes[6][4])
+{
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        float r0 = m[i * 4 + 0];
+        float r1 = m[i * 4 + 1];
+        float r2 = m[i * 4 + 2];
+        float r3 = m[i * 4 + 3];
+
+        planes[0][i] = r3 + r0; /* left */
+        planes[1][i] = r3 - r0; /* right */
+        planes[2][i] = r3 + r1; /* bottom */
+        planes[3][i] = r3 - r1; /* top */
+        planes[4][i] = r2;      /* near */
+        planes[5][i] = r3 - r2; /* far */
+    }
+
+    // normalize, so the distance can be compared against the radius
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        float length = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+        if (length <= 0.0f) continue;
+
+        for (uint32_t j = 0; j < 4; ++j)
+            planes[i][j] /= length;
+    }
+}
+
+uint8_t ignisCreateCuller(uint32_t maxObjects, VkShaderModule cullShader, IgnisCuller* culler)
+{
+    if (!cullShader)
+    {
+        IGNIS_ERROR("Cull shader module is missing");
+        return IGNIS_FAIL;
+    }
+
+    memset(culler, 0, sizeof(IgnisCuller));
+    culler->maxObjects = maxObjects;
+    culler->compact = ignisGetDeviceFeatures()->drawIndirectCount;
+
+    /* buffers */
+    VkDeviceSize objectSize = sizeof(IgnisCullObject) * maxObjects;
+    if (!ignisCreateBufferStaged(NULL, objectSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &culler->objects))
+        return IGNIS_FAIL;
+
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    for (uint32_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        if (!ignisCreateBufferStaged(NULL, sizeof(VkDrawIndexedIndirectCommand) * maxObjects, usage, &culler->commands[i]))
+            return IGNIS_FAIL;
+
+        if (!ignisCreateBufferStaged(NULL, sizeof(uint32_t), usage, &culler->counts[i]))
+            return IGNIS_FAIL;
+    }
+
+    /* pipeline */
+    VkDescriptorType bindings[] = {
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /* objects */
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, /* commands */
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER  /* count */
+    };
+
+    VkPushConstantRange pushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(IgnisCullConstants)
+    };
+
+    IgnisComputePipelineConfig config = {
+        .bindings = bindings,
+        .bindingCount = sizeof(bindings) / sizeof(bindings[0]),
+        .pushConstantRanges = &pushConstantRange,
+        .pushConstantRangeCount = 1,
+        .groupSize = { IGNIS_CULL_GROUP_SIZE, 1, 1 }
+    };
+
+    if (!ignisCreateComputePipeline(&config, cullShader, &culler->pipeline))
+    {
+        IGNIS_ERROR("failed to create cull pipeline!");
+        return IGNIS_FAIL;
+    }
+
+    // output buffers are per frame, so the previous frame can still draw from its commands
+    for (uint32_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        ignisSetComputeBuffer(&culler->pipeline, i, 0, culler->objects.handle, 0, VK_WHOLE_SIZE);
+        ignisSetComputeBuffer(&culler->pipeline, i, 1, culler->commands[i].handle, 0, VK_WHOLE_SIZE);
+        ignisSetComputeBuffer(&culler->pipeline, i, 2, culler->counts[i].handle, 0, VK_WHOLE_SIZE);
+    }
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyCuller(IgnisCuller* culler)
+{
+    ignisDestroyComputePipeline(&culler->pipeline);
+
+    for (uint32_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        ignisDestroyBuffer(&culler->commands[i]);
+        ignisDestroyBuffer(&culler->counts[i]);
+    }
+
+    ignisDestroyBuffer(&culler->objects);
+}
+
+uint8_t ignisSetCullObjects(IgnisCuller* culler, const IgnisCullObject* objects, uint32_t count)
+{
+    if (count > culler->maxObjects)
+    {
+        IGNIS_ERROR("Too many cull objects (%d/%d)", count, culler->maxObjects);
+        return IGNIS_FAIL;
+    }
+
+    culler->objectCount = count;
+    if (!count) return IGNIS_OK;
+
+    IgnisUploadTicket ticket = ignisUploadBuffer(&culler->objects, 0, objects, sizeof(IgnisCullObject) * count);
+    if (!ticket)
+    {
+        IGNIS_ERROR("failed to upload cull objects!");
+        return IGNIS_FAIL;
+    }
+
+    // batched uploads are waited for by the owner of the batch
+    if (!ignisUploadBatching())
+        ignisWaitUpload(ticket);
+
+    return IGNIS_OK;
+}
+
+void ignisCullObjects(VkCommandBuffer commandBuffer, IgnisCuller* culler, const float* viewProj)
+{
+    if (!culler->objectCount) return;
+
+    uint32_t frame = ignisGetCurrentFrame();
+
+    // the count is accumulated with atomics and has to start at 0
+    if (culler->compact)
+    {
+        vkCmdFillBuffer(commandBuffer, culler->counts[frame].handle, 0, sizeof(uint32_t), 0);
+
+        ignisBufferBarrier(commandBuffer, culler->counts[frame].handle,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    }
+
+    IgnisCullConstants constants = {
+        .objectCount = culler->objectCount,
+        .compact = culler->compact
+    };
+    ignisExtractFrustumPlanes(viewProj, constants.planes);
+
+    ignisBindComputePipeline(commandBuffer, &culler->pipeline);
+    ignisPushComputeConstants(commandBuffer, &culler->pipeline, 0, sizeof(IgnisCullConstants), &constants);
+    ignisDispatch(commandBuffer, &culler->pipeline, culler->objectCount, 1, 1);
+
+    // make the commands and the count visible to the indirect draw
+    ignisMemoryBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+void ignisDrawCulled(VkCommandBuffer commandBuffer, const IgnisCuller* culler)
+{
+    if (!culler->objectCount) return;
+
+    uint32_t frame = ignisGetCurrentFrame();
+    uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    if (culler->compact)
+    {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, culler->commands[frame].handle, 0, culler->counts[frame].handle, 0, culler->objectCount, stride);
+    }
+    else if (ignisGetDeviceFeatures()->multiDrawIndirect)
+    {
+        vkCmdDrawIndexedIndirect(commandBuffer, culler->commands[frame].handle, 0, culler->objectCount, stride);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < culler->objectCount; ++i)
+            vkCmdDrawIndexedIndirect(commandBuffer, culler->commands[frame].handle, i * stride, 1, stride);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef IGNIS_CULLING_H
+#define IGNIS_CULLING_H
+
+#include "ignis_core.h"
+
+#include "buffer.h"
+#include "pipeline.h"
+
+/*
+ * GPU driven indirect drawing. Objects are described by a bounding sphere
+ * and the parameters of their indexed draw. A compute pass culls them
+ * against the view frustum and writes a VkDrawIndexedIndirectCommand for
+ * every visible object, which the graphics pass consumes with a single
+ * indirect draw.
+ *
+ * With drawIndirectCount the commands are compacted and the draw count is
+ * read from the gpu, otherwise culled objects are written with an instance
+ * count of 0. Objects are drawn with one instance, firstInstance can be
+ * used to look up per object data in the shader.
+ */
+typedef struct
+{
+    float center[3];
+    float radius;
+
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t  vertexOffset;
+    uint32_t firstInstance;
+} IgnisCullObject;
+
+#define IGNIS_CULL_GROUP_SIZE 64 /* has to match local_size_x of cull.comp */
+
+typedef struct
+{
+    IgnisComputePipeline pipeline;
+
+    IgnisBuffer objects;
+    IgnisBuffer commands[IGNIS_MAX_FRAMES_IN_FLIGHT];
+    IgnisBuffer counts[IGNIS_MAX_FRAMES_IN_FLIGHT];
+
+    uint32_t maxObjects;
+    uint32_t objectCount;
+
+    uint8_t compact; /* commands are compacted and counted on the gpu */
+} IgnisCuller;
+
+/* cullShader is the compiled res/shader/cull.comp */
+uint8_t ignisCreateCuller(uint32_t maxObjects, VkShaderModule cullShader, IgnisCuller* culler);
+void ignisDestroyCuller(IgnisCuller* culler);
+
+/* uploads the objects, must not be called while frames using them are in flight */
+uint8_t ignisSetCullObjects(IgnisCuller* culler, const IgnisCullObject* objects, uint32_t count);
+
+/* viewProj is column major, records outside of rendering (see ignisGetCommandBuffer) */
+void ignisCullObjects(VkCommandBuffer commandBuffer, IgnisCuller* culler, const float* viewProj);
+
+/* expects index and vertex buffers to be bound */
+void ignisDrawCulled(VkCommandBuffer commandBuffer, const IgnisCuller* culler);
+
+#endif /* !IGNIS_CULLING_H */
@@ -0,0 +1,151 @@
+#include "deletion_queue.h"
+
+#include "thread.h"
+
+typedef struct
+{
+    uint64_t frameValue;
+    IgnisDeletionType type;
+    IgnisDeletionHandle handle;
+
+    /* IGNIS_DELETE_OBJECT */
+    IgnisDeletionFunc func;
+    void* object;
+    size_t size;
+} IgnisDeletion;
+
+static struct IgnisDeletionQueue
+{
+    IgnisMutex* mutex;
+
+    IgnisDeletion* deletions;
+    uint32_t count;
+    uint32_t capacity;
+} queue;
+
+static void ignisDelete(IgnisDeletionType type, IgnisDeletionHandle* handle, IgnisDeletionFunc func, void* object)
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    switch (type)
+    {
+    case IGNIS_DELETE_BUFFER:   vkDestroyBuffer(device, handle->buffer, allocator); break;
+    case IGNIS_DELETE_SAMPLER:  vkDestroySampler(device, handle->sampler, allocator); break;
+    case IGNIS_DELETE_MEMORY:   ignisFreeDeviceMemory(&handle->allocation); break;
+    case IGNIS_DELETE_OBJECT:   func(object); break;
+    }
+}
+
+static void ignisDeleteQueued(IgnisDeletion* deletion)
+{
+    ignisDelete(deletion->type, &deletion->handle, deletion->func, deletion->object);
+    ignisFree(deletion->object, deletion->size);
+}
+
+uint8_t ignisCreateDeletionQueue()
+{
+    memset(&queue, 0, sizeof(queue));
+
+    queue.mutex = ignisCreateMutex();
+    return queue.mutex != NULL;
+}
+
+void ignisDestroyDeletionQueue()
+{
+    for (uint32_t i = 0; i < queue.count; ++i)
+        ignisDeleteQueued(&queue.deletions[i]);
+
+    ignisFree(queue.deletions, sizeof(IgnisDeletion) * queue.capacity);
+    ignisDestroyMutex(queue.mutex);
+
+    memset(&queue, 0, sizeof(queue));
+}
+
+static uint8_t ignisPushDeletion(const IgnisDeletion* deletion)
+{
+    if (!queue.mutex) return IGNIS_FAIL;
+
+    ignisLockMutex(queue.mutex);
+
+    uint8_t result = ignisReserve((void**)&queue.deletions, &queue.capacity, queue.count + 1, sizeof(IgnisDeletion));
+    if (result)
+        queue.deletions[queue.count++] = *deletion;
+
+    ignisUnlockMutex(queue.mutex);
+
+    return result;
+}
+
+void ignisDeferDeletion(IgnisDeletionType type, IgnisDeletionHandle handle)
+{
+    IgnisDeletion deletion = {
+        .frameValue = ignisGetFrameValue(),
+        .type = type,
+        .handle = handle
+    };
+
+    if (ignisPushDeletion(&deletion))
+        return;
+
+    // no queue to wait for the frames
+    if (queue.mutex)
+    {
+        IGNIS_WARN("failed to queue deletion, waiting for the device");
+        vkDeviceWaitIdle(ignisGetVkDevice());
+    }
+    ignisDelete(type, &handle, NULL, NULL);
+}
+
+void ignisDeferObject(IgnisDeletionFunc func, const void* object, size_t size)
+{
+    IgnisDeletion deletion = {
+        .frameValue = ignisGetFrameValue(),
+        .type = IGNIS_DELETE_OBJECT,
+        .func = func,
+        .object = queue.mutex ? ignisAlloc(size) : NULL,
+        .size = size
+    };
+
+    if (deletion.object)
+    {
+        memcpy(deletion.object, object, size);
+        if (ignisPushDeletion(&deletion))
+            return;
+
+        ignisFree(deletion.object, size);
+    }
+
+    // no queue to wait for the frames
+    if (queue.mutex)
+    {
+        IGNIS_WARN("failed to queue deletion, waiting for the device");
+        vkDeviceWaitIdle(ignisGetVkDevice());
+    }
+    func((void*)object);
+}
+
+void ignisCollectDeletions()
+{
+    ignisLockMutex(queue.mutex);
+
+    uint32_t i = 0;
+    while (i < queue.count)
+    {
+        if (!ignisFrameComplete(queue.deletions[i].frameValue))
+        {
+            ++i;
+            continue;
+        }
+
+        IgnisDeletion deletion = queue.deletions[i];
+        queue.deletions[i] = queue.deletions[--queue.count];
+
+        // deleting objects may queue further deletions
+        ignisUnlockMutex(queue.mutex);
+        ignisDeleteQueued(&deletion);
+        ignisLockMutex(queue.mutex);
+    }
+
+    ignisUnlockMutex(queue.mutex);
+}
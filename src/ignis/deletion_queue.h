@@ -0,0 +1,46 @@
+#ifndef IGNIS_DELETION_QUEUE_H
+#define IGNIS_DELETION_QUEUE_H
+
+#include "ignis_core.h"
+
+/*
+ * Defers the destruction of objects that frames in flight may still use.
+ * Each deletion is tagged with the value of the frame being recorded and
+ * carried out by ignisCollectDeletions once that frame completed, so
+ * resources can be released at any time without waiting for the device.
+ *
+ * Deletions may be queued from any thread. Without a queue (before it is
+ * created or after it was destroyed) objects are deleted immediately.
+ */
+typedef enum
+{
+    IGNIS_DELETE_BUFFER,
+    IGNIS_DELETE_SAMPLER,
+    IGNIS_DELETE_MEMORY,
+    IGNIS_DELETE_OBJECT
+} IgnisDeletionType;
+
+/* deletes an object composed of several handles */
+typedef void (*IgnisDeletionFunc)(void* object);
+
+typedef union
+{
+    VkBuffer buffer;
+    VkSampler sampler;
+    IgnisAllocation allocation;
+} IgnisDeletionHandle;
+
+uint8_t ignisCreateDeletionQueue();
+
+/* deletes everything that is left, the device has to be idle */
+void ignisDestroyDeletionQueue();
+
+void ignisDeferDeletion(IgnisDeletionType type, IgnisDeletionHandle handle);
+
+/* object is copied and passed to func, which must not free it */
+void ignisDeferObject(IgnisDeletionFunc func, const void* object, size_t size);
+
+/* deletes everything whose frame completed */
+void ignisCollectDeletions();
+
+#endif /* !IGNIS_DELETION_QUEUE_H */
@@ -0,0 +1,98 @@
+#include "frame_allocator.h"
+
+#include "thread.h"
+
+static struct IgnisFrameAllocator
+{
+    IgnisDynamicBuffer buffer;
+
+    VkDeviceSize frameSize;
+    VkDeviceSize uniformAlignment;
+
+    VkDeviceSize begin; /* region of the current frame */
+    VkDeviceSize head;
+
+    /* allocations are made from parallel recording jobs */
+    IgnisMutex* mutex;
+} frameAllocator;
+
+static VkDeviceSize ignisFrameAlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint8_t ignisCreateFrameAllocator(VkDeviceSize frameSize)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(ignisGetVkPhysicalDevice(), &properties);
+
+    frameAllocator.uniformAlignment = properties.limits.minUniformBufferOffsetAlignment;
+    frameAllocator.frameSize = ignisFrameAlignUp(frameSize, frameAllocator.uniformAlignment);
+
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                             | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                             | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+    // descriptor sets reference the buffer, so it keeps a region for every possible frame
+    VkDeviceSize size = frameAllocator.frameSize * IGNIS_MAX_FRAMES_IN_FLIGHT;
+    if (!ignisCreateDynamicBuffer(size, usage, &frameAllocator.buffer))
+    {
+        IGNIS_ERROR("failed to create frame allocator buffer!");
+        return IGNIS_FAIL;
+    }
+
+    frameAllocator.begin = 0;
+    frameAllocator.head = 0;
+
+    frameAllocator.mutex = ignisCreateMutex();
+    return frameAllocator.mutex != NULL;
+}
+
+void ignisDestroyFrameAllocator()
+{
+    ignisDestroyDynamicBuffer(&frameAllocator.buffer);
+    ignisDestroyMutex(frameAllocator.mutex);
+    frameAllocator.mutex = NULL;
+}
+
+void ignisResetFrameAllocator(uint32_t frame)
+{
+    frameAllocator.begin = frame * frameAllocator.frameSize;
+    frameAllocator.head = frameAllocator.begin;
+}
+
+void ignisFlushFrameAllocator()
+{
+    VkDeviceSize size = frameAllocator.head - frameAllocator.begin;
+    if (size) ignisFlushDynamicBuffer(&frameAllocator.buffer, frameAllocator.begin, size);
+}
+
+uint8_t ignisFrameAllocate(VkDeviceSize size, VkDeviceSize alignment, IgnisFrameAllocation* allocation)
+{
+    ignisLockMutex(frameAllocator.mutex);
+
+    VkDeviceSize offset = ignisFrameAlignUp(frameAllocator.head, alignment);
+    if (offset + size > frameAllocator.begin + frameAllocator.frameSize)
+    {
+        ignisUnlockMutex(frameAllocator.mutex);
+        IGNIS_WARN("frame allocator is out of memory");
+        return IGNIS_FAIL;
+    }
+
+    frameAllocator.head = offset + size;
+
+    ignisUnlockMutex(frameAllocator.mutex);
+
+    allocation->buffer = frameAllocator.buffer.handle;
+    allocation->offset = offset;
+    allocation->data = (char*)frameAllocator.buffer.data + offset;
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisFrameAllocateUniform(VkDeviceSize size, IgnisFrameAllocation* allocation)
+{
+    return ignisFrameAllocate(size, frameAllocator.uniformAlignment, allocation);
+}
+
+VkBuffer ignisGetFrameAllocatorBuffer() { return frameAllocator.buffer.handle; }
@@ -0,0 +1,31 @@
+#ifndef IGNIS_FRAME_ALLOCATOR_H
+#define IGNIS_FRAME_ALLOCATOR_H
+
+#include "ignis_core.h"
+
+#include "buffer.h"
+
+/*
+ * Linear allocator for data that only lives for one frame (uniforms,
+ * vertices, indices). Each frame in flight owns a region of one large
+ * dynamic buffer, which is reset once the frame that used it completed.
+ */
+typedef struct
+{
+    VkBuffer buffer;
+    VkDeviceSize offset; /* offset into buffer */
+    void* data;
+} IgnisFrameAllocation;
+
+uint8_t ignisCreateFrameAllocator(VkDeviceSize frameSize);
+void ignisDestroyFrameAllocator();
+
+void ignisResetFrameAllocator(uint32_t frame);
+void ignisFlushFrameAllocator();
+
+uint8_t ignisFrameAllocate(VkDeviceSize size, VkDeviceSize alignment, IgnisFrameAllocation* allocation);
+uint8_t ignisFrameAllocateUniform(VkDeviceSize size, IgnisFrameAllocation* allocation);
+
+VkBuffer ignisGetFrameAllocatorBuffer();
+
+#endif /* !IGNIS_FRAME_ALLOCATOR_H */
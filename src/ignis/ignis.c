@@ -1,21 +1,30 @@
 #include "ignis.h"
 
+#ifdef WINDOWS
 #include <Windows.h>
 #include <vulkan/vulkan_win32.h>
+#endif
 
-uint8_t ignisInit(const char* name, uint32_t width, uint32_t height, const void* platformHandle)
+uint8_t ignisInit(const char* name, uint32_t width, uint32_t height, const void* platformHandle, IgnisInitConfig* configPtr)
 {
+    IgnisInitConfig config = configPtr ? *configPtr : IGNIS_DEFAULT_INIT_CONFIG;
+
+    // without a platform handle ignis runs headless and renders into offscreen images
+    uint8_t headless = platformHandle == NULL;
+
+    const char* extensions[3];
+    uint32_t extensionCount = 0;
+
     // TODO: make platform agnostic
-    const char* const extensions[] = {
-        VK_KHR_SURFACE_EXTENSION_NAME,
-        "VK_KHR_win32_surface",
+    if (!headless)
+    {
+        extensions[extensionCount++] = VK_KHR_SURFACE_EXTENSION_NAME;
+        extensions[extensionCount++] = "VK_KHR_win32_surface";
+    }
+
 #ifdef IGNIS_DEBUG
-        VK_EXT_DEBUG_UTILS_EXTENSION_NAME
+    extensions[extensionCount++] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
 #endif
-    };
-
-    const uint32_t extensionCount = sizeof(extensions) / sizeof(extensions[0]);
-    // const char* const extensions = platform->queryExtensions(&extensionCount);
 
     if (!ignisCreateInstance(name, extensions, extensionCount))
     {
@@ -24,24 +33,32 @@ uint8_t ignisInit(const char* name, uint32_t width, uint32_t height, const void*
     }
 
     // Surface
-    VkSurfaceKHR surface;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
 
-    // TODO: make platform agnostic
-    VkWin32SurfaceCreateInfoKHR create_info = {
-        .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
-        .hinstance = GetModuleHandleW(NULL),
-        .hwnd = platformHandle,
-        .flags = 0
-    };
-
-    VkResult result = vkCreateWin32SurfaceKHR(ignisGetVkInstance(), &create_info, ignisGetAllocator(), &surface);
-    if (result != VK_SUCCESS)
+    if (!headless)
     {
-        IGNIS_ERROR("Failed to create window surface with result: %u", result);
+#ifdef WINDOWS
+        // TODO: make platform agnostic
+        VkWin32SurfaceCreateInfoKHR create_info = {
+            .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
+            .hinstance = GetModuleHandleW(NULL),
+            .hwnd = (HWND)platformHandle,
+            .flags = 0
+        };
+
+        VkResult result = vkCreateWin32SurfaceKHR(ignisGetVkInstance(), &create_info, ignisGetAllocator(), &surface);
+        if (result != VK_SUCCESS)
+        {
+            IGNIS_ERROR("Failed to create window surface with result: %u", result);
+            return IGNIS_FAIL;
+        }
+#else
+        IGNIS_ERROR("Window surfaces are only supported on windows, pass no platform handle to run headless");
         return IGNIS_FAIL;
+#endif
     }
 
-    if (!ignisCreateContext(surface, (VkExtent2D) { width, height }))
+    if (!ignisCreateContext(surface, (VkExtent2D) { width, height }, &config))
     {
         IGNIS_ERROR("Failed to create context");
         return IGNIS_FAIL;
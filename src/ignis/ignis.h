@@ -3,7 +3,7 @@
 
 #include "ignis_core.h"
 
-uint8_t ignisInit(const char* name, uint32_t width, uint32_t height, const void* platformHandle);
+uint8_t ignisInit(const char* name, uint32_t width, uint32_t height, const void* platformHandle, IgnisInitConfig* configPtr);
 void ignisTerminate();
 
 /*
@@ -5,12 +5,35 @@
 #include "swapchain.h"
 
 #include "texture.h"
+#include "upload.h"
+#include "frame_allocator.h"
+#include "bindless.h"
+#include "pipeline_cache.h"
+#include "pipeline_registry.h"
+#include "thread.h"
+#include "parallel.h"
+#include "deletion_queue.h"
+
+typedef struct
+{
+    VkCullModeFlags cullMode;
+    VkFrontFace frontFace;
+    VkPrimitiveTopology topology;
+    VkBool32 depthTest;
+    VkBool32 depthWrite;
+    VkCompareOp depthCompareOp;
+    VkPolygonMode polygonMode;
+    VkBool32 blendEnable;
+} IgnisRasterState;
 
 typedef struct
 {
     VkInstance instance;
     VkSurfaceKHR surface;
 
+    /* no surface, frames are rendered into device owned images */
+    uint8_t headless;
+
 #ifdef IGNIS_DEBUG
     VkDebugUtilsMessengerEXT debugMessenger;
 #endif
@@ -22,29 +45,65 @@ typedef struct
     uint32_t queueFamilyIndices[IGNIS_QUEUE_FAMILY_MAX_ENUM];
 
     VkQueue queueGraphics;
+    VkQueue queueTransfer;
     VkQueue queuePresent;
 
+    IgnisDeviceFeatures features;
+
+    IgnisAllocator allocator;
+
     IgnisSwapchain swapchain;
 
+    /* replaced swapchains, destroyed after the first acquire from their successor */
+    IgnisSwapchain* retired;
+    uint32_t retiredCount;
+    uint32_t retiredCapacity;
+
     /* Sync objects */
-    VkSemaphore imageAvailable[IGNIS_MAX_FRAMES_IN_FLIGHT];
-    VkSemaphore renderFinished[IGNIS_MAX_FRAMES_IN_FLIGHT];
-    VkFence     inFlightFences[IGNIS_MAX_FRAMES_IN_FLIGHT];
+    /* per frame in flight */
+    uint32_t framesInFlight;
+    VkSemaphore* imageAvailable;
+    VkSemaphore* renderFinished;
+
+    /* signaled with the frame value once a frame's commands completed */
+    VkSemaphore frameTimeline;
+    uint64_t frameValue;     /* value of the frame being recorded */
+    uint64_t completedValue; /* last value known to be signaled */
 
     uint16_t swapchainGeneration;
     uint16_t swapchainLastGeneration;
 
     VkCommandPool commandPool;
-    VkCommandBuffer commandBuffers[IGNIS_MAX_FRAMES_IN_FLIGHT];
+    VkCommandBuffer* commandBuffers;
+
+    /* requested swapchain image count, 0 lets the surface decide */
+    uint32_t imageCount;
+
+    /* extent requested by the last resize, applied at the next frame */
+    VkExtent2D requestedExtent;
 
     uint32_t currentFrame;
     uint32_t imageIndex;
 
+    /* upload timeline value the current command buffer has to wait for */
+    uint64_t uploadWaitValue;
+
     // state
     VkViewport viewport;
     VkRect2D scissor;
     VkClearValue clearColor;
     VkClearValue depthStencil;
+    IgnisRasterState raster;
+
+    IgnisAttachmentOps attachmentOps;
+    IgnisAttachmentOps passOps; /* ops of the rendering in progress */
+
+    /* raster state is recorded directly between begin and end command buffer */
+    uint8_t rendering;
+
+    /* VK_EXT_extended_dynamic_state3 */
+    PFN_vkCmdSetPolygonModeEXT cmdSetPolygonMode;
+    PFN_vkCmdSetColorBlendEnableEXT cmdSetColorBlendEnable;
 } IgnisContext;
 
 
@@ -161,12 +220,16 @@ uint8_t ignisCreateInstance(const char* name, const char* const* extensions, uin
 
 static uint8_t ignisCreateDevice();
 static uint8_t ignisCreateSwapchainSyncObjects();
+static uint32_t ignisGetRequestedImageCount();
+static uint8_t ignisCreateFrameResources();
+static void ignisDestroyFrameResources();
 
-uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent)
+uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent, const IgnisInitConfig* config)
 {
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
     context.surface = surface;
+    context.headless = surface == VK_NULL_HANDLE;
 
     /* create device */
     if (!ignisCreateDevice())
@@ -175,6 +238,32 @@ uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent)
         return IGNIS_FAIL;
     }
 
+    /* matches the state pipelines were created with before it became dynamic */
+    context.raster = (IgnisRasterState){
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .depthTest = VK_TRUE,
+        .depthWrite = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .blendEnable = VK_TRUE
+    };
+
+    /* create memory allocator */
+    if (!ignisCreateAllocator(context.device, context.physicalDevice, allocator, &context.allocator))
+    {
+        IGNIS_ERROR("failed to create memory allocator");
+        return IGNIS_FAIL;
+    }
+
+    /* create deletion queue */
+    if (!ignisCreateDeletionQueue())
+    {
+        IGNIS_ERROR("failed to create deletion queue");
+        return IGNIS_FAIL;
+    }
+
     /* create command pool */
     VkCommandPoolCreateInfo commandPoolInfo = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
@@ -188,26 +277,84 @@ uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent)
         return IGNIS_FAIL;
     }
 
-    /* allocate command buffers */
-    VkCommandBufferAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandPool = context.commandPool,
-        .commandBufferCount = IGNIS_MAX_FRAMES_IN_FLIGHT
-    };
+    /* allocate command buffers and sync objects for each frame in flight */
+    context.framesInFlight = config->framesInFlight ? config->framesInFlight : IGNIS_DEFAULT_FRAMES_IN_FLIGHT;
+    if (context.framesInFlight > IGNIS_MAX_FRAMES_IN_FLIGHT)
+    {
+        IGNIS_WARN("invalid number of frames in flight: %d", context.framesInFlight);
+        context.framesInFlight = IGNIS_DEFAULT_FRAMES_IN_FLIGHT;
+    }
 
-    if (vkAllocateCommandBuffers(context.device, &allocInfo, context.commandBuffers) != VK_SUCCESS)
+    if (!ignisCreateFrameResources())
+    {
+        IGNIS_ERROR("Failed to create frame resources");
+        return IGNIS_FAIL;
+    }
+
+    /* create pipeline cache */
+    if (!ignisCreatePipelineCache(config->pipelineCachePath))
     {
-        IGNIS_ERROR("Failed to allocate command buffers");
+        IGNIS_ERROR("failed to create pipeline cache");
+        return IGNIS_FAIL;
+    }
+
+    /* create pipeline registry */
+    if (!ignisCreatePipelineRegistry())
+    {
+        IGNIS_ERROR("failed to create pipeline registry");
+        return IGNIS_FAIL;
+    }
+
+    /* create worker pool */
+    if (!ignisCreateWorkerPool(config->workerCount))
+    {
+        IGNIS_ERROR("failed to create worker pool");
+        return IGNIS_FAIL;
+    }
+
+    /* create command pools for parallel recording */
+    if (!ignisCreateParallelRecorder())
+    {
+        IGNIS_ERROR("failed to create parallel recorder");
+        return IGNIS_FAIL;
+    }
+
+    /* create upload queue */
+    if (!ignisCreateUploadQueue(config->stagingSize))
+    {
+        IGNIS_ERROR("failed to create upload queue");
+        return IGNIS_FAIL;
+    }
+
+    /* create frame allocator */
+    if (!ignisCreateFrameAllocator(config->frameDataSize))
+    {
+        IGNIS_ERROR("failed to create frame allocator");
+        return IGNIS_FAIL;
+    }
+
+    /* create bindless texture table */
+    if (!ignisCreateBindlessTable())
+    {
+        IGNIS_ERROR("failed to create bindless texture table");
         return IGNIS_FAIL;
     }
 
     /* create swapchain */
-    if (!ignisCreateSwapchain(context.device, context.physicalDevice, context.surface, VK_NULL_HANDLE, extent, allocator, &context.swapchain))
+    context.imageCount = config->imageCount;
+    context.requestedExtent = extent;
+
+    uint8_t swapchainCreated = context.headless
+        ? ignisCreateHeadlessSwapchain(context.device, context.physicalDevice, extent, ignisGetRequestedImageCount(), allocator, &context.swapchain)
+        : ignisCreateSwapchain(context.device, context.physicalDevice, context.surface, VK_NULL_HANDLE, extent, ignisGetRequestedImageCount(), allocator, &context.swapchain);
+
+    if (!swapchainCreated || !ignisCreateSwapchainDepth(context.device, context.framesInFlight, allocator, &context.swapchain))
     {
         IGNIS_CRITICAL("failed to create swapchain");
         return IGNIS_FAIL;
     }
+
+    context.attachmentOps = IGNIS_DEFAULT_ATTACHMENT_OPS;
     
     /* create swapchain */
     if (!ignisCreateSwapchainSyncObjects())
@@ -229,20 +376,39 @@ void ignisDestroyContext()
 {
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
-    for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
-    {
-        vkDestroySemaphore(context.device, context.imageAvailable[i], allocator);
-        vkDestroySemaphore(context.device, context.renderFinished[i], allocator);
-        vkDestroyFence(context.device, context.inFlightFences[i], allocator);
-    }
+    // frames in flight may still use objects queued for deletion
+    vkDeviceWaitIdle(context.device);
+
+    // finish pending background work before anything is destroyed
+    ignisDestroyWorkerPool();
+
+    // objects destroyed from here on are deleted immediately
+    ignisDestroyDeletionQueue();
+
+    ignisDestroyParallelRecorder();
+    ignisDestroyUploadQueue();
+    ignisDestroyFrameAllocator();
+    ignisDestroyBindlessTable();
+    ignisDestroyPipelineCache();
+    ignisDestroyPipelineRegistry();
+
+    ignisDestroyFrameResources();
+    vkDestroySemaphore(context.device, context.frameTimeline, allocator);
 
     vkDestroyCommandPool(context.device, context.commandPool, allocator);
 
+    for (uint32_t i = 0; i < context.retiredCount; ++i)
+        ignisDestroySwapchain(context.device, allocator, &context.retired[i]);
+    ignisFree(context.retired, sizeof(IgnisSwapchain) * context.retiredCapacity);
+
     ignisDestroySwapchain(context.device, allocator, &context.swapchain);
 
+    ignisDestroyAllocator(&context.allocator);
+
     vkDestroyDevice(context.device, allocator);
 
-    vkDestroySurfaceKHR(context.instance, context.surface, allocator);
+    if (context.surface)
+        vkDestroySurfaceKHR(context.instance, context.surface, allocator);
 
 #ifdef IGNIS_DEBUG
 
@@ -260,13 +426,36 @@ void ignisDestroyContext()
 /* ---------------------------------| Device |------------------------------------------ */
 
 // Device requirements
+#define IGNIS_MAX_DEVICE_EXTENSIONS 16
+
 static const char* const REQ_EXTENSIONS[] = {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
 };
 
 static const uint32_t REQ_EXTENSION_COUNT = sizeof(REQ_EXTENSIONS) / sizeof(REQ_EXTENSIONS[0]);
 
+// only required if the context presents to a surface
+static const char* const REQ_PRESENT_EXTENSIONS[] = {
+    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+};
+
+static const uint32_t REQ_PRESENT_EXTENSION_COUNT = sizeof(REQ_PRESENT_EXTENSIONS) / sizeof(REQ_PRESENT_EXTENSIONS[0]);
+
+// enable fast linking of pipelines from libraries, if supported
+static const char* const PIPELINE_LIBRARY_EXTENSIONS[] = {
+    VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+    VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+};
+
+static const uint32_t PIPELINE_LIBRARY_EXTENSION_COUNT = sizeof(PIPELINE_LIBRARY_EXTENSIONS) / sizeof(PIPELINE_LIBRARY_EXTENSIONS[0]);
+
+// dynamic polygon mode and blend enable, if supported
+static const char* const DYNAMIC_STATE_EXTENSIONS[] = {
+    VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
+};
+
+static const uint32_t DYNAMIC_STATE_EXTENSION_COUNT = sizeof(DYNAMIC_STATE_EXTENSIONS) / sizeof(DYNAMIC_STATE_EXTENSIONS[0]);
+
 static const uint32_t REQ_QUEUE_FAMILIES = IGNIS_QUEUE_GRAPHICS_BIT
                                          | IGNIS_QUEUE_TRANSFER_BIT
                                          | IGNIS_QUEUE_PRESENT_BIT;
@@ -293,37 +482,83 @@ uint8_t ignisCreateDevice()
 
     vkEnumeratePhysicalDevices(context.instance, &count, devices);
 
+    uint32_t reqQueueFamilies = REQ_QUEUE_FAMILIES;
+    if (context.headless)
+        reqQueueFamilies &= ~IGNIS_QUEUE_PRESENT_BIT;
+
     context.physicalDevice = VK_NULL_HANDLE;
     for (uint32_t i = 0; i < count; ++i)
     {
         // skip device if required queue families are not supported
         uint32_t familyIndices[IGNIS_QUEUE_FAMILY_MAX_ENUM];
         uint32_t familiesSet = ignisFindQueueFamilies(devices[i], context.surface, familyIndices);
-        if (!(familiesSet & REQ_QUEUE_FAMILIES))
-            continue;
-
-        // skip device if required swapchain is not support
-        if (!ignisQuerySwapChainSupport(devices[i], context.surface))
+        if (!(familiesSet & reqQueueFamilies))
             continue;
 
         // skip device if required extensions are not supported
         if (!ignisCheckDeviceExtensionSupport(devices[i], REQ_EXTENSIONS, REQ_EXTENSION_COUNT))
             continue;
 
-        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT
+        if (!context.headless)
+        {
+            // skip device if required swapchain is not support
+            if (!ignisQuerySwapChainSupport(devices[i], context.surface))
+                continue;
+
+            if (!ignisCheckDeviceExtensionSupport(devices[i], REQ_PRESENT_EXTENSIONS, REQ_PRESENT_EXTENSION_COUNT))
+                continue;
+        }
+        else
+        {
+            // no present queue needed, alias it to the graphics queue
+            familyIndices[IGNIS_QUEUE_PRESENT] = familyIndices[IGNIS_QUEUE_GRAPHICS];
+        }
+
+        // skip device if it does not support Vulkan 1.3 (barriers, dynamic state and rendering)
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(devices[i], &properties);
+        if (properties.apiVersion < VK_API_VERSION_1_3)
+            continue;
+
+        VkPhysicalDeviceVulkan13Features features13 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES
+        };
+
+        VkPhysicalDeviceVulkan12Features features12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = &features13
         };
 
         VkPhysicalDeviceFeatures2 supportedFeatures = {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-            .pNext = &indexingFeatures
+            .pNext = &features12
         };
         vkGetPhysicalDeviceFeatures2(devices[i], &supportedFeatures);
 
+        // skip if dynamic rendering or synchronization2 are not supported
+        if (!features13.dynamicRendering || !features13.synchronization2)
+            continue;
+
         // skip if sampler anisotropy is not supported
         if (!supportedFeatures.features.samplerAnisotropy)
             continue;
 
+        // skip if timeline semaphores are not supported (needed for uploads)
+        if (!features12.timelineSemaphore)
+            continue;
+
+        // skip if the bindless texture table is not supported
+        if (!features12.runtimeDescriptorArray
+            || !features12.descriptorBindingPartiallyBound
+            || !features12.descriptorBindingSampledImageUpdateAfterBind
+            || !features12.descriptorBindingUpdateUnusedWhilePending
+            || !features12.shaderSampledImageArrayNonUniformIndexing)
+            continue;
+
+        // optional features
+        context.features.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+        context.features.drawIndirectCount = features12.drawIndirectCount;
+
         // suitable device found
         context.physicalDevice = devices[i];
         context.queueFamiliesSet = familiesSet;
@@ -339,6 +574,54 @@ uint8_t ignisCreateDevice()
         return IGNIS_FAIL;
     }
 
+    // graphics pipeline libraries are only used if linking them is fast
+    if (ignisCheckDeviceExtensionSupport(context.physicalDevice, PIPELINE_LIBRARY_EXTENSIONS, PIPELINE_LIBRARY_EXTENSION_COUNT))
+    {
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT
+        };
+
+        VkPhysicalDeviceFeatures2 supportedFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &libraryFeatures
+        };
+        vkGetPhysicalDeviceFeatures2(context.physicalDevice, &supportedFeatures);
+
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT
+        };
+
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &libraryProperties
+        };
+        vkGetPhysicalDeviceProperties2(context.physicalDevice, &properties);
+
+        context.features.graphicsPipelineLibrary = libraryFeatures.graphicsPipelineLibrary
+                                                && libraryProperties.graphicsPipelineLibraryFastLinking;
+    }
+
+    // cull mode, front face, topology and depth state are dynamic in core 1.3
+    if (ignisCheckDeviceExtensionSupport(context.physicalDevice, DYNAMIC_STATE_EXTENSIONS, DYNAMIC_STATE_EXTENSION_COUNT))
+    {
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicStateFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT
+        };
+
+        VkPhysicalDeviceFeatures2 supportedFeatures = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &dynamicStateFeatures
+        };
+        vkGetPhysicalDeviceFeatures2(context.physicalDevice, &supportedFeatures);
+
+        // polygon modes other than fill need non solid fill modes
+        context.features.dynamicPolygonMode = dynamicStateFeatures.extendedDynamicState3PolygonMode
+                                           && supportedFeatures.features.fillModeNonSolid;
+        context.features.dynamicBlendEnable = dynamicStateFeatures.extendedDynamicState3ColorBlendEnable;
+    }
+
+    uint8_t dynamicState3 = context.features.dynamicPolygonMode || context.features.dynamicBlendEnable;
+
     // create logical device
     uint32_t queueCount = 0;
     VkDeviceQueueCreateInfo queueCreateInfos[IGNIS_QUEUE_FAMILY_MAX_ENUM] = { 0 };
@@ -358,26 +641,88 @@ uint8_t ignisCreateDevice()
     }
 
     // enable device features
-    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+    void* optionalFeatures = NULL;
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+        .graphicsPipelineLibrary = VK_TRUE
+    };
+
+    if (context.features.graphicsPipelineLibrary)
+        optionalFeatures = &libraryFeatures;
+
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicStateFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+        .pNext = optionalFeatures,
+        .extendedDynamicState3PolygonMode = context.features.dynamicPolygonMode,
+        .extendedDynamicState3ColorBlendEnable = context.features.dynamicBlendEnable
+    };
+
+    if (dynamicState3)
+        optionalFeatures = &dynamicStateFeatures;
+
+    VkPhysicalDeviceVulkan12Features features12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = optionalFeatures,
+        .timelineSemaphore = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .drawIndirectCount = context.features.drawIndirectCount,
+    };
+
+    // synchronization2 is used by the render graph
+    VkPhysicalDeviceVulkan13Features features13 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .pNext = &features12,
         .dynamicRendering = VK_TRUE,
+        .synchronization2 = VK_TRUE
     };
 
     VkPhysicalDeviceFeatures2 deviceFeatures = { 
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
         .features = {
-            .samplerAnisotropy = VK_TRUE
+            .samplerAnisotropy = VK_TRUE,
+            .multiDrawIndirect = context.features.multiDrawIndirect,
+            .fillModeNonSolid = context.features.dynamicPolygonMode
         },
-        .pNext = &dynamicRenderingFeatures
+        .pNext = &features13
     };
 
+    // collect device extensions
+    const char* extensions[IGNIS_MAX_DEVICE_EXTENSIONS];
+    uint32_t extensionCount = 0;
+
+    for (uint32_t i = 0; i < REQ_EXTENSION_COUNT; ++i)
+        extensions[extensionCount++] = REQ_EXTENSIONS[i];
+
+    if (!context.headless)
+    {
+        for (uint32_t i = 0; i < REQ_PRESENT_EXTENSION_COUNT; ++i)
+            extensions[extensionCount++] = REQ_PRESENT_EXTENSIONS[i];
+    }
+
+    if (context.features.graphicsPipelineLibrary)
+    {
+        for (uint32_t i = 0; i < PIPELINE_LIBRARY_EXTENSION_COUNT; ++i)
+            extensions[extensionCount++] = PIPELINE_LIBRARY_EXTENSIONS[i];
+    }
+
+    if (dynamicState3)
+    {
+        for (uint32_t i = 0; i < DYNAMIC_STATE_EXTENSION_COUNT; ++i)
+            extensions[extensionCount++] = DYNAMIC_STATE_EXTENSIONS[i];
+    }
+
     // create device
     VkDeviceCreateInfo createInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
         .pQueueCreateInfos = queueCreateInfos,
         .queueCreateInfoCount = queueCount,
-        .ppEnabledExtensionNames = REQ_EXTENSIONS,
-        .enabledExtensionCount = REQ_EXTENSION_COUNT,
+        .ppEnabledExtensionNames = extensions,
+        .enabledExtensionCount = extensionCount,
         .pNext = &deviceFeatures
     };
 
@@ -387,8 +732,15 @@ uint8_t ignisCreateDevice()
 
     // get queues
     vkGetDeviceQueue(context.device, context.queueFamilyIndices[IGNIS_QUEUE_GRAPHICS], 0, &context.queueGraphics);
+    vkGetDeviceQueue(context.device, context.queueFamilyIndices[IGNIS_QUEUE_TRANSFER], 0, &context.queueTransfer);
     vkGetDeviceQueue(context.device, context.queueFamilyIndices[IGNIS_QUEUE_PRESENT], 0, &context.queuePresent);
 
+    if (context.features.dynamicPolygonMode)
+        context.cmdSetPolygonMode = IGNIS_VK_DEVICE_PFN(context.device, vkCmdSetPolygonModeEXT);
+
+    if (context.features.dynamicBlendEnable)
+        context.cmdSetColorBlendEnable = IGNIS_VK_DEVICE_PFN(context.device, vkCmdSetColorBlendEnableEXT);
+
     return IGNIS_OK;
 }
 
@@ -438,6 +790,10 @@ uint32_t ignisFindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface, u
             }
         }
 
+        // headless contexts have no surface to present to
+        if (surface == VK_NULL_HANDLE)
+            continue;
+
         VkBool32 supported = VK_FALSE;
         vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &supported);
         if (supported)
@@ -463,74 +819,267 @@ uint8_t ignisQuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface
 }
 
 /* ---------------------------------| Swapchain |--------------------------------------- */
+uint32_t ignisGetRequestedImageCount()
+{
+    // headless images are not acquired, so every frame in flight needs its own
+    if (context.headless && context.imageCount && context.imageCount < context.framesInFlight)
+        return context.framesInFlight;
+
+    return context.imageCount;
+}
+
 uint8_t ignisCreateSwapchainSyncObjects()
 {
+    VkSemaphoreTypeCreateInfo timelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+
     VkSemaphoreCreateInfo semaphoreInfo = {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timelineInfo
     };
 
-    VkFenceCreateInfo fenceInfo = {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-        .flags = VK_FENCE_CREATE_SIGNALED_BIT
+    if (vkCreateSemaphore(context.device, &semaphoreInfo, ignisGetAllocator(), &context.frameTimeline) != VK_SUCCESS)
+        return IGNIS_FAIL;
+
+    // the first frame signals 1
+    context.frameValue = 1;
+    context.completedValue = 0;
+
+    return IGNIS_OK;
+}
+
+/* ---------------------------------| Frames in flight |-------------------------------- */
+uint8_t ignisCreateFrameResources()
+{
+    uint32_t count = context.framesInFlight;
+
+    context.commandBuffers = ignisAlloc(sizeof(VkCommandBuffer) * count);
+    context.imageAvailable = ignisAlloc(sizeof(VkSemaphore) * count);
+    context.renderFinished = ignisAlloc(sizeof(VkSemaphore) * count);
+
+    if (!context.commandBuffers || !context.imageAvailable || !context.renderFinished)
+        return IGNIS_FAIL;
+
+    memset(context.imageAvailable, 0, sizeof(VkSemaphore) * count);
+    memset(context.renderFinished, 0, sizeof(VkSemaphore) * count);
+
+    VkCommandBufferAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandPool = context.commandPool,
+        .commandBufferCount = count
+    };
+
+    if (vkAllocateCommandBuffers(context.device, &allocInfo, context.commandBuffers) != VK_SUCCESS)
+        return IGNIS_FAIL;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
     };
 
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
-    for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    for (uint32_t i = 0; i < count; ++i)
     {
         if (vkCreateSemaphore(context.device, &semaphoreInfo, allocator, &context.imageAvailable[i]) != VK_SUCCESS)
             return IGNIS_FAIL;
 
         if (vkCreateSemaphore(context.device, &semaphoreInfo, allocator, &context.renderFinished[i]) != VK_SUCCESS)
             return IGNIS_FAIL;
+    }
 
-        if (vkCreateFence(context.device, &fenceInfo, allocator, &context.inFlightFences[i]) != VK_SUCCESS)
-            return IGNIS_FAIL;
+    return IGNIS_OK;
+}
+
+void ignisDestroyFrameResources()
+{
+    uint32_t count = context.framesInFlight;
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    if (context.imageAvailable && context.renderFinished)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            vkDestroySemaphore(context.device, context.imageAvailable[i], allocator);
+            vkDestroySemaphore(context.device, context.renderFinished[i], allocator);
+        }
+    }
+
+    if (context.commandBuffers)
+        vkFreeCommandBuffers(context.device, context.commandPool, count, context.commandBuffers);
+
+    ignisFree(context.commandBuffers, sizeof(VkCommandBuffer) * count);
+    ignisFree(context.imageAvailable, sizeof(VkSemaphore) * count);
+    ignisFree(context.renderFinished, sizeof(VkSemaphore) * count);
+
+    context.commandBuffers = NULL;
+    context.imageAvailable = NULL;
+    context.renderFinished = NULL;
+}
+
+uint8_t ignisSetFramesInFlight(uint32_t count)
+{
+    if (count < 1 || count > IGNIS_MAX_FRAMES_IN_FLIGHT)
+    {
+        IGNIS_WARN("invalid number of frames in flight: %d", count);
+        return IGNIS_FAIL;
+    }
+
+    if (count == context.framesInFlight)
+        return IGNIS_OK;
+
+    // frame resources are reallocated, so nothing may be in flight
+    vkDeviceWaitIdle(context.device);
+
+    ignisDestroyFrameResources();
+    ignisDestroySwapchainDepth(context.device, ignisGetAllocator(), &context.swapchain);
+
+    context.framesInFlight = count;
+    context.currentFrame = 0;
+
+    if (!ignisCreateFrameResources())
+    {
+        IGNIS_ERROR("Failed to create frame resources");
+        return IGNIS_FAIL;
+    }
+
+    if (!ignisCreateSwapchainDepth(context.device, count, ignisGetAllocator(), &context.swapchain))
+    {
+        // retried by the next frame
+        ignisDestroySwapchainDepth(context.device, ignisGetAllocator(), &context.swapchain);
+        IGNIS_ERROR("Failed to create depth attachments");
+        return IGNIS_FAIL;
+    }
+
+    // more headless frames than images would write to images still in flight
+    if (context.headless && context.swapchain.imageCount < count)
+        context.swapchainGeneration++;
+
+    IGNIS_TRACE("Using %d frames in flight", count);
+    return IGNIS_OK;
+}
+
+void ignisSetSwapchainImageCount(uint32_t count)
+{
+    context.imageCount = count;
+    context.swapchainGeneration++;
+}
+
+
+uint8_t ignisAllocateDeviceMemory(VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocationType type, IgnisAllocation* allocation)
+{
+    return ignisAllocatorAlloc(&context.allocator, requirements, required, preferred, type, allocation);
+}
+
+void ignisFreeDeviceMemory(IgnisAllocation* allocation)
+{
+    ignisAllocatorFree(&context.allocator, allocation);
+}
+
+uint8_t ignisFlushDeviceMemory(const IgnisAllocation* allocation, VkDeviceSize offset, VkDeviceSize size)
+{
+    return ignisAllocatorFlush(&context.allocator, allocation, offset, size);
+}
+
+uint8_t ignisAllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocation* allocation)
+{
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(context.device, buffer, &requirements);
+
+    if (!ignisAllocateDeviceMemory(requirements, required, preferred, IGNIS_ALLOCATION_LINEAR, allocation))
+        return IGNIS_FAIL;
+
+    if (vkBindBufferMemory(context.device, buffer, allocation->memory, allocation->offset) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to bind buffer memory!");
+        ignisFreeDeviceMemory(allocation);
+        return IGNIS_FAIL;
     }
 
     return IGNIS_OK;
 }
 
+uint8_t ignisAllocateImageMemory(VkImage image, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocation* allocation)
+{
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(context.device, image, &requirements);
 
-VkDeviceMemory ignisAllocateDeviceMemory(VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, const VkAllocationCallbacks* allocator)
+    if (!ignisAllocateDeviceMemory(requirements, required, preferred, IGNIS_ALLOCATION_OPTIMAL, allocation))
+        return IGNIS_FAIL;
+
+    if (vkBindImageMemory(context.device, image, allocation->memory, allocation->offset) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to bind image memory!");
+        ignisFreeDeviceMemory(allocation);
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+/* ---------------------------------| Swapchain recreation |---------------------------- */
+static void ignisDeleteSwapchain(void* swapchain)
 {
-    VkPhysicalDeviceMemoryProperties memoryProps;
-    vkGetPhysicalDeviceMemoryProperties(context.physicalDevice, &memoryProps);
+    ignisDestroySwapchain(context.device, ignisGetAllocator(), swapchain);
+}
 
-    uint32_t memoryTypeIndex = memoryProps.memoryTypeCount;
-    for (uint32_t i = 0; i < memoryProps.memoryTypeCount; ++i)
+static uint8_t ignisUpdateSwapchain()
+{
+    if (context.swapchainGeneration != context.swapchainLastGeneration)
     {
-        if ((requirements.memoryTypeBits & (1 << i)) && (memoryProps.memoryTypes[i].propertyFlags & properties) == properties)
+        if (!ignisReserve((void**)&context.retired, &context.retiredCapacity, context.retiredCount + 1, sizeof(IgnisSwapchain)))
+            return IGNIS_FAIL;
+
+        IgnisSwapchain retired;
+        uint8_t result = ignisRecreateSwapchain(context.device, context.physicalDevice, context.surface, context.requestedExtent, ignisGetRequestedImageCount(), ignisGetAllocator(), &context.swapchain, &retired);
+
+        // the old handle is retired even if creation failed, a swapchain left
+        // empty by an earlier failure has nothing to retire
+        if (retired.handle || retired.images)
+            context.retired[context.retiredCount++] = retired;
+
+        if (!result)
         {
-            memoryTypeIndex = i;
-            break;
+            // the next frame starts over without an old swapchain
+            ignisDestroySwapchain(context.device, ignisGetAllocator(), &context.swapchain);
+            memset(&context.swapchain, 0, sizeof(IgnisSwapchain));
+            return IGNIS_FAIL;
         }
+
+        context.swapchainLastGeneration = context.swapchainGeneration;
     }
 
-    if (memoryTypeIndex == memoryProps.memoryTypeCount)
+    // a swapchain whose depth attachments failed keeps being used, only they are retried
+    if (!ignisCreateSwapchainDepth(context.device, context.framesInFlight, ignisGetAllocator(), &context.swapchain))
     {
-        IGNIS_ERROR("failed to find suitable memory type!");
-        return VK_NULL_HANDLE;
+        ignisDestroySwapchainDepth(context.device, ignisGetAllocator(), &context.swapchain);
+        return IGNIS_FAIL;
     }
 
-    VkMemoryAllocateInfo allocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = requirements.size,
-        .memoryTypeIndex = memoryTypeIndex
-    };
+    return IGNIS_OK;
+}
 
-    VkDeviceMemory memory = VK_NULL_HANDLE;
-    if (vkAllocateMemory(context.device, &allocInfo, allocator, &memory) != VK_SUCCESS)
-        IGNIS_ERROR("failed to find allocate device memory!");
+static void ignisReleaseRetiredSwapchains()
+{
+    // presents are not tracked by the timeline, but an acquire from the new
+    // swapchain means the presentation engine moved on from the old images.
+    // Deferring to the frame being recorded also covers every frame that used them.
+    for (uint32_t i = 0; i < context.retiredCount; ++i)
+        ignisDeferObject(ignisDeleteSwapchain, &context.retired[i], sizeof(IgnisSwapchain));
 
-    return memory;
+    context.retiredCount = 0;
 }
 
-static VkExtent2D cachedExtent;
-
 uint8_t ignisResize(uint32_t width, uint32_t height)
 {
-    cachedExtent.width = width;
-    cachedExtent.height = height;
+    // a burst of resize events recreates the swapchain once at the next frame
+    if (context.requestedExtent.width == width && context.requestedExtent.height == height)
+        return IGNIS_OK;
+
+    context.requestedExtent.width = width;
+    context.requestedExtent.height = height;
     context.swapchainGeneration++;
 
     return IGNIS_OK;
@@ -538,39 +1087,88 @@ uint8_t ignisResize(uint32_t width, uint32_t height)
 
 uint8_t ignisBeginFrame()
 {
-    // Check if swapchain is out of date.
-    if (context.swapchainGeneration != context.swapchainLastGeneration)
+    // Check if swapchain is out of date or misses its depth attachments.
+    if (context.swapchainGeneration != context.swapchainLastGeneration || !context.swapchain.depthImages)
     {
         // window is minimized
-        if (cachedExtent.width == 0 || cachedExtent.height == 0)
+        if (context.requestedExtent.width == 0 || context.requestedExtent.height == 0)
             return IGNIS_FAIL;
 
-        if (!ignisRecreateSwapchain(context.device, context.physicalDevice, context.surface, cachedExtent, ignisGetAllocator(), &context.swapchain))
+        if (!ignisUpdateSwapchain())
         {
             IGNIS_ERROR("Failed to recreate swapchain");
             return IGNIS_FAIL;
         }
-        context.swapchainLastGeneration = context.swapchainGeneration;
 
         IGNIS_TRACE("Recreated Swapchchain");
     }
 
-    // acquire next image index
-    vkWaitForFences(context.device, 1, &context.inFlightFences[context.currentFrame], VK_TRUE, -1);
+    // wait for the frame that last used this frame's resources
+    if (context.frameValue > context.framesInFlight)
+        ignisWaitFrame(context.frameValue - context.framesInFlight);
 
-    VkSemaphore semaphore = context.imageAvailable[context.currentFrame];
-    VkResult result = vkAcquireNextImageKHR(context.device, context.swapchain.handle, -1, semaphore, VK_NULL_HANDLE, &context.imageIndex);
+    // delete objects no frame uses anymore
+    ignisCollectDeletions();
 
-    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    // Begin recording commands.
+    VkCommandBuffer commandBuffer = context.commandBuffers[context.currentFrame];
+    vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0);
+
+    VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        IGNIS_WARN("failed to begin recording command buffer!");
         return IGNIS_FAIL;
+    }
 
-    vkResetFences(context.device, 1, &context.inFlightFences[context.currentFrame]);
+    if (context.headless)
+    {
+        // offscreen images are used round robin, nothing to acquire
+        context.imageIndex = (context.frameValue - 1) % context.swapchain.imageCount;
+        ignisReleaseRetiredSwapchains();
+    }
+    else
+    {
+        // acquire next image index
+        VkSemaphore semaphore = context.imageAvailable[context.currentFrame];
+        VkResult result = vkAcquireNextImageKHR(context.device, context.swapchain.handle, -1, semaphore, VK_NULL_HANDLE, &context.imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+            context.swapchainGeneration++;
+
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+            return IGNIS_FAIL;
+
+        ignisReleaseRetiredSwapchains();
+    }
+
+    // the gpu is done with this frame's transient data
+    ignisResetFrameAllocator(context.currentFrame);
+    ignisResetParallelRecorder(context.currentFrame);
+
+    // release staging memory of finished uploads
+    ignisCollectUploads();
+
+    // take ownership of resources uploaded on the transfer queue
+    context.uploadWaitValue = ignisAcquireUploads(commandBuffer);
 
     return IGNIS_OK;
 }
 
 uint8_t ignisEndFrame()
 {
+    if (context.headless)
+    {
+        /* next frame */
+        context.currentFrame = (context.currentFrame + 1) % context.framesInFlight;
+        context.frameValue++;
+        return IGNIS_OK;
+    }
+
     VkSemaphore waitSemaphores[] = { context.renderFinished[context.currentFrame] };
 
     VkPresentInfoKHR presentInfo = {
@@ -582,74 +1180,82 @@ uint8_t ignisEndFrame()
         .pImageIndices = &context.imageIndex
     };
 
-    if (vkQueuePresentKHR(context.queuePresent, &presentInfo) != VK_SUCCESS)
+    VkResult result = vkQueuePresentKHR(context.queuePresent, &presentInfo);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+        context.swapchainGeneration++; // recreated at the next frame
+    else if (result != VK_SUCCESS)
         IGNIS_WARN("failed to present frame");
 
     /* next frame */
-    context.currentFrame = (context.currentFrame + 1) % IGNIS_MAX_FRAMES_IN_FLIGHT;
+    context.currentFrame = (context.currentFrame + 1) % context.framesInFlight;
+    context.frameValue++;
 
     return IGNIS_OK;
 }
 
 
-VkCommandBuffer ignisBeginCommandBuffer()
-{
-    // Begin recording commands.
-    VkCommandBuffer commandBuffer = context.commandBuffers[context.currentFrame];
-    vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0);
+uint64_t ignisGetFrameValue() { return context.frameValue; }
 
-    VkCommandBufferBeginInfo beginInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = 0
-    };
+VkSemaphore ignisGetFrameSemaphore() { return context.frameTimeline; }
 
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
-    {
-        IGNIS_WARN("failed to begin recording command buffer!");
-        return VK_NULL_HANDLE;
-    }
+uint8_t ignisFrameComplete(uint64_t value)
+{
+    if (value <= context.completedValue)
+        return 1;
 
-    ignisTransitionImageLayout(
-        commandBuffer,
-        context.swapchain.images[context.imageIndex],
-        VK_IMAGE_ASPECT_COLOR_BIT,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-    );
+    vkGetSemaphoreCounterValue(context.device, context.frameTimeline, &context.completedValue);
+    return value <= context.completedValue;
+}
 
-    ignisTransitionImageLayout(
-        commandBuffer,
-        context.swapchain.depthImages[context.imageIndex],
-        VK_IMAGE_ASPECT_DEPTH_BIT,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
-    );
+void ignisWaitFrame(uint64_t value)
+{
+    if (ignisFrameComplete(value))
+        return;
+
+    VkSemaphoreWaitInfo waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &context.frameTimeline,
+        .pValues = &value
+    };
 
-    // set dynamic state
-    vkCmdSetViewport(commandBuffer, 0, 1, &context.viewport);
-    vkCmdSetScissor(commandBuffer, 0, 1, &context.scissor);
+    if (vkWaitSemaphores(context.device, &waitInfo, UINT64_MAX) == VK_SUCCESS)
+        context.completedValue = value;
+}
+
+VkCommandBuffer ignisGetCommandBuffer()
+{
+    return context.commandBuffers[context.currentFrame];
+}
 
-    // begin dynamic rendering
+/*
+ * The frame is rendered as one render pass instance, that is suspended and
+ * resumed to switch contents. Load ops are only executed by the first and
+ * store ops by the last instance, so the depth never has to be stored.
+ */
+static void ignisBeginRendering(VkCommandBuffer commandBuffer, VkRenderingFlags flags)
+{
     VkRenderingAttachmentInfo colorAttachmentInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
         .imageView = context.swapchain.imageViews[context.imageIndex],
         .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .loadOp = context.passOps.colorLoadOp,
+        .storeOp = context.passOps.colorStoreOp,
         .clearValue = context.clearColor,
     };
 
     VkRenderingAttachmentInfo depthAttachmentInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
-        .imageView = context.swapchain.depthImageViews[context.imageIndex],
+        .imageView = context.swapchain.depthImageViews[context.currentFrame],
         .imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR,
-        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .loadOp = context.passOps.depthLoadOp,
+        .storeOp = context.passOps.depthStoreOp,
         .clearValue = context.depthStencil,
     };
 
     VkRenderingInfo renderInfo = {
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+        .flags = flags,
         .renderArea.offset = { 0, 0 },
         .renderArea.extent = context.swapchain.extent,
         .layerCount = 1,
@@ -659,50 +1265,138 @@ VkCommandBuffer ignisBeginCommandBuffer()
     };
 
     vkCmdBeginRendering(commandBuffer, &renderInfo);
+}
 
-    return commandBuffer;
+void ignisRecordDynamicState(VkCommandBuffer commandBuffer)
+{
+    vkCmdSetViewport(commandBuffer, 0, 1, &context.viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &context.scissor);
+
+    vkCmdSetCullMode(commandBuffer, context.raster.cullMode);
+    vkCmdSetFrontFace(commandBuffer, context.raster.frontFace);
+    vkCmdSetPrimitiveTopology(commandBuffer, context.raster.topology);
+    vkCmdSetDepthTestEnable(commandBuffer, context.raster.depthTest);
+    vkCmdSetDepthWriteEnable(commandBuffer, context.raster.depthWrite);
+    vkCmdSetDepthCompareOp(commandBuffer, context.raster.depthCompareOp);
+
+    if (context.cmdSetPolygonMode)
+        context.cmdSetPolygonMode(commandBuffer, context.raster.polygonMode);
+
+    if (context.cmdSetColorBlendEnable)
+        context.cmdSetColorBlendEnable(commandBuffer, 0, 1, &context.raster.blendEnable);
 }
 
-void ignisEndCommandBuffer(VkCommandBuffer commandBuffer)
+void ignisContinueRendering(VkCommandBuffer commandBuffer, VkRenderingFlags flags)
 {
     vkCmdEndRendering(commandBuffer);
+    ignisBeginRendering(commandBuffer, flags | VK_RENDERING_RESUMING_BIT | VK_RENDERING_SUSPENDING_BIT);
+
+    // executing secondary command buffers leaves the state undefined
+    if (!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT))
+        ignisRecordDynamicState(commandBuffer);
+}
+
+VkCommandBuffer ignisBeginCommandBuffer()
+{
+    VkCommandBuffer commandBuffer = context.commandBuffers[context.currentFrame];
 
     ignisTransitionImageLayout(
         commandBuffer,
         context.swapchain.images[context.imageIndex],
         VK_IMAGE_ASPECT_COLOR_BIT,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
     );
 
+    // depth is not kept between frames
     ignisTransitionImageLayout(
         commandBuffer,
-        context.swapchain.depthImages[context.imageIndex],
+        context.swapchain.depthImages[context.currentFrame],
         VK_IMAGE_ASPECT_DEPTH_BIT,
-        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL
+    );
+
+    // resumed instances have to match the first one
+    context.passOps = context.attachmentOps;
+
+    ignisRecordDynamicState(commandBuffer);
+    ignisBeginRendering(commandBuffer, VK_RENDERING_SUSPENDING_BIT);
+
+    context.rendering = 1;
+
+    return commandBuffer;
+}
+
+void ignisEndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    // an empty last instance ends the suspended rendering
+    vkCmdEndRendering(commandBuffer);
+    ignisBeginRendering(commandBuffer, VK_RENDERING_RESUMING_BIT);
+    vkCmdEndRendering(commandBuffer);
+    context.rendering = 0;
+
+    // headless frames are kept ready to be copied out, PRESENT_SRC needs VK_KHR_swapchain
+    VkImageLayout finalLayout = context.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    ignisTransitionImageLayout(
+        commandBuffer,
+        context.swapchain.images[context.imageIndex],
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        finalLayout
     );
 
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
         IGNIS_WARN("failed to record command buffer!");
 
-    VkSemaphore waitSemaphores[] = { context.imageAvailable[context.currentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    ignisFlushFrameAllocator();
 
-    VkSemaphore signalSemaphores[] = { context.renderFinished[context.currentFrame] };
+    VkSemaphore waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint64_t waitValues[2];
+    uint32_t waitCount = 0;
+
+    if (!context.headless)
+    {
+        waitSemaphores[waitCount] = context.imageAvailable[context.currentFrame];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitValues[waitCount++] = 0; // binary semaphore, value is ignored
+    }
+
+    if (context.uploadWaitValue)
+    {
+        waitSemaphores[waitCount] = ignisGetUploadSemaphore();
+        waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        waitValues[waitCount++] = context.uploadWaitValue;
+    }
+
+    // headless frames have nothing to present
+    VkSemaphore signalSemaphores[] = { context.frameTimeline, context.renderFinished[context.currentFrame] };
+    uint64_t signalValues[] = { context.frameValue, 0 };
+    uint32_t signalCount = context.headless ? 1 : 2;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount = waitCount,
+        .pWaitSemaphoreValues = waitValues,
+        .signalSemaphoreValueCount = signalCount,
+        .pSignalSemaphoreValues = signalValues
+    };
 
     VkSubmitInfo submitInfo = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
         .pWaitSemaphores = waitSemaphores,
         .pWaitDstStageMask = waitStages,
-        .waitSemaphoreCount = 1,
+        .waitSemaphoreCount = waitCount,
         .pCommandBuffers = &commandBuffer,
         .commandBufferCount = 1,
         .pSignalSemaphores = signalSemaphores,
-        .signalSemaphoreCount = 1
+        .signalSemaphoreCount = signalCount
     };
 
-    if (vkQueueSubmit(context.queueGraphics, 1, &submitInfo, context.inFlightFences[context.currentFrame]) != VK_SUCCESS)
+    if (vkQueueSubmit(context.queueGraphics, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
         IGNIS_WARN("failed to submit frame");
 }
 
@@ -753,6 +1447,12 @@ VkFormat ignisGetSwapchainDepthFormat() { return context.swapchain.depthFormat;
 
 VkExtent2D ignisGetSwapchainExtent() { return context.swapchain.extent; }
 
+VkImage ignisGetCurrentSwapchainImage() { return context.swapchain.images[context.imageIndex]; }
+
+uint8_t ignisIsHeadless() { return context.headless; }
+
+const IgnisDeviceFeatures* ignisGetDeviceFeatures() { return &context.features; }
+
 float ignisGetMaxSamplerAnisotropy()
 {
     VkPhysicalDeviceProperties properties = { 0 };
@@ -760,10 +1460,22 @@ float ignisGetMaxSamplerAnisotropy()
     return properties.limits.maxSamplerAnisotropy;
 }
 
+uint32_t ignisGetFramesInFlight() { return context.framesInFlight; }
 uint32_t ignisGetCurrentFrame() { return context.currentFrame; }
 
 uint32_t ignisGetQueueFamilyIndex(IgnisQueueFamily family) { return context.queueFamilyIndices[family]; }
 
+VkQueue ignisGetQueue(IgnisQueueFamily family)
+{
+    switch (family)
+    {
+    case IGNIS_QUEUE_GRAPHICS: return context.queueGraphics;
+    case IGNIS_QUEUE_TRANSFER: return context.queueTransfer;
+    case IGNIS_QUEUE_PRESENT:  return context.queuePresent;
+    default: return VK_NULL_HANDLE;
+    }
+}
+
 float ignisGetAspectRatio()
 {
     return context.swapchain.extent.width / (float)context.swapchain.extent.height;
@@ -772,6 +1484,15 @@ float ignisGetAspectRatio()
 
 const VkAllocationCallbacks* ignisGetAllocator() { return NULL; }
 
+uint32_t ignisGetMemoryHeapCount() { return context.allocator.properties.memoryHeapCount; }
+
+IgnisMemoryHeapStats ignisGetMemoryHeapStats(uint32_t heap) { return context.allocator.heapStats[heap]; }
+
+
+void ignisSetAttachmentOps(const IgnisAttachmentOps* ops)
+{
+    context.attachmentOps = ops ? *ops : IGNIS_DEFAULT_ATTACHMENT_OPS;
+}
 
 void ignisSetClearColor(float r, float g, float b, float a)
 {
@@ -809,6 +1530,66 @@ void ignisSetScissor(int32_t x, int32_t y, uint32_t w, uint32_t h)
     context.scissor.extent.height = h;
 }
 
+void ignisSetCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace)
+{
+    context.raster.cullMode = cullMode;
+    context.raster.frontFace = frontFace;
+
+    if (!context.rendering) return;
+
+    VkCommandBuffer commandBuffer = context.commandBuffers[context.currentFrame];
+    vkCmdSetCullMode(commandBuffer, cullMode);
+    vkCmdSetFrontFace(commandBuffer, frontFace);
+}
+
+void ignisSetPrimitiveTopology(VkPrimitiveTopology topology)
+{
+    context.raster.topology = topology;
+
+    if (context.rendering)
+        vkCmdSetPrimitiveTopology(context.commandBuffers[context.currentFrame], topology);
+}
+
+void ignisSetDepthTest(uint8_t test, uint8_t write, VkCompareOp compareOp)
+{
+    context.raster.depthTest = test ? VK_TRUE : VK_FALSE;
+    context.raster.depthWrite = write ? VK_TRUE : VK_FALSE;
+    context.raster.depthCompareOp = compareOp;
+
+    if (!context.rendering) return;
+
+    VkCommandBuffer commandBuffer = context.commandBuffers[context.currentFrame];
+    vkCmdSetDepthTestEnable(commandBuffer, context.raster.depthTest);
+    vkCmdSetDepthWriteEnable(commandBuffer, context.raster.depthWrite);
+    vkCmdSetDepthCompareOp(commandBuffer, compareOp);
+}
+
+uint8_t ignisSetPolygonMode(VkPolygonMode mode)
+{
+    if (!context.cmdSetPolygonMode)
+        return IGNIS_FAIL;
+
+    context.raster.polygonMode = mode;
+
+    if (context.rendering)
+        context.cmdSetPolygonMode(context.commandBuffers[context.currentFrame], mode);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisSetBlendEnable(uint8_t enable)
+{
+    if (!context.cmdSetColorBlendEnable)
+        return IGNIS_FAIL;
+
+    context.raster.blendEnable = enable ? VK_TRUE : VK_FALSE;
+
+    if (context.rendering)
+        context.cmdSetColorBlendEnable(context.commandBuffers[context.currentFrame], 0, 1, &context.raster.blendEnable);
+
+    return IGNIS_OK;
+}
+
 void ignisPrintInfo()
 {
     VkPhysicalDeviceProperties properties;
@@ -851,4 +1632,19 @@ void ignisPrintInfo()
         else
             IGNIS_INFO("    Shared: %.2f GiB", memory_size_gib);
     }
+}
+
+void ignisPrintMemoryStats()
+{
+    IGNIS_INFO("Device memory:");
+    for (uint32_t i = 0; i < context.allocator.properties.memoryHeapCount; ++i)
+    {
+        IgnisMemoryHeapStats stats = context.allocator.heapStats[i];
+
+        float used_mib = ((float)stats.usedBytes) / 1024.0f / 1024.0f;
+        float block_mib = ((float)stats.blockBytes) / 1024.0f / 1024.0f;
+
+        IGNIS_INFO("  > Heap %u: %.2f / %.2f MiB in %u allocation(s), %u block(s)",
+            i, used_mib, block_mib, stats.allocationCount, stats.blockCount);
+    }
 }
\ No newline at end of file
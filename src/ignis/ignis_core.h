@@ -4,13 +4,42 @@
 #include <vulkan/vulkan.h>
 
 #include "common.h"
+#include "allocator.h"
 
 /* --------------------------| context |--------------------------------- */
+typedef struct
+{
+    VkDeviceSize stagingSize;   /* size of the staging ring shared by all uploads */
+    VkDeviceSize frameDataSize; /* per frame memory for transient uniforms and vertices */
+    const char* pipelineCachePath; /* NULL keeps the pipeline cache in memory only */
+    uint32_t workerCount;          /* threads for background work, 0 uses all but one core */
+    uint32_t framesInFlight;       /* 1 for lowest latency up to IGNIS_MAX_FRAMES_IN_FLIGHT, 0 uses the default */
+    uint32_t imageCount;           /* swapchain images, 0 uses one more than the surface minimum */
+} IgnisInitConfig;
+
+#define IGNIS_MAX_FRAMES_IN_FLIGHT      3
+
+#define IGNIS_DEFAULT_STAGING_SIZE      (32ull * 1024 * 1024)
+#define IGNIS_DEFAULT_FRAME_DATA_SIZE   (4ull * 1024 * 1024)
+#define IGNIS_DEFAULT_PIPELINE_CACHE    "pipeline.cache"
+#define IGNIS_DEFAULT_FRAMES_IN_FLIGHT  2
+#define IGNIS_DEFAULT_INIT_CONFIG       (IgnisInitConfig){ IGNIS_DEFAULT_STAGING_SIZE, IGNIS_DEFAULT_FRAME_DATA_SIZE, IGNIS_DEFAULT_PIPELINE_CACHE, 0, IGNIS_DEFAULT_FRAMES_IN_FLIGHT, 0 }
+
 uint8_t ignisCreateInstance(const char* name, const char* const* extensions, uint32_t count);
-uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent);
+uint8_t ignisCreateContext(VkSurfaceKHR surface, VkExtent2D extent, const IgnisInitConfig* config);
 
 void ignisDestroyContext();
 
+/* optional device features, enabled when supported */
+typedef struct
+{
+    uint8_t multiDrawIndirect;
+    uint8_t drawIndirectCount;
+    uint8_t graphicsPipelineLibrary; /* with fast linking */
+    uint8_t dynamicPolygonMode;      /* ignisSetPolygonMode */
+    uint8_t dynamicBlendEnable;      /* ignisSetBlendEnable */
+} IgnisDeviceFeatures;
+
 typedef enum
 {
     IGNIS_QUEUE_GRAPHICS,
@@ -28,24 +57,98 @@ typedef enum
     IGNIS_QUEUE_PRESENT_BIT  = 0x0008
 } ignisQueueFamilyBits;
 
-VkDeviceMemory ignisAllocateDeviceMemory(VkMemoryRequirements requirements, VkMemoryPropertyFlags properties, const VkAllocationCallbacks* allocator);
+/* memory */
+uint8_t ignisAllocateDeviceMemory(VkMemoryRequirements requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocationType type, IgnisAllocation* allocation);
+void ignisFreeDeviceMemory(IgnisAllocation* allocation);
+
+uint8_t ignisFlushDeviceMemory(const IgnisAllocation* allocation, VkDeviceSize offset, VkDeviceSize size);
+
+/* allocate and bind memory for a resource */
+uint8_t ignisAllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocation* allocation);
+uint8_t ignisAllocateImageMemory(VkImage image, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, IgnisAllocation* allocation);
 
 
 uint8_t ignisResize(uint32_t width, uint32_t height);
 
+/*
+ * Changing the number of frames in flight waits for the device to idle and
+ * reallocates the per frame resources. The swapchain image count is applied
+ * when the swapchain is recreated at the beginning of the next frame.
+ */
+uint8_t ignisSetFramesInFlight(uint32_t count);
+void    ignisSetSwapchainImageCount(uint32_t count);
+
+/*
+ * Load and store operations of the frame's color and depth attachments.
+ * Depth is transient and only kept during the frame, so it is not stored
+ * by default. Changes apply from the next ignisBeginCommandBuffer.
+ */
+typedef struct
+{
+    VkAttachmentLoadOp colorLoadOp;
+    VkAttachmentStoreOp colorStoreOp;
+    VkAttachmentLoadOp depthLoadOp;
+    VkAttachmentStoreOp depthStoreOp;
+} IgnisAttachmentOps;
+
+#define IGNIS_DEFAULT_ATTACHMENT_OPS (IgnisAttachmentOps){ VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE }
+
+/* NULL restores the default */
+void ignisSetAttachmentOps(const IgnisAttachmentOps* ops);
+
 void ignisSetClearColor(float r, float g, float b, float a);
 void ignisSetDepthStencil(float depth, uint32_t stencil);
 void ignisSetViewport(float x, float y, float width, float height);
 void ignisSetDepthRange(float nearVal, float farVal);
 void ignisSetScissor(int32_t x, int32_t y, uint32_t w, uint32_t h);
 
+/*
+ * Raster state is dynamic in every graphics pipeline, so one pipeline serves
+ * all combinations of it. The state is kept across frames and recorded by
+ * ignisBeginCommandBuffer, calls while rendering apply to the following draws.
+ * The topology can only change within the class of the pipeline's topology.
+ */
+void ignisSetCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace);
+void ignisSetPrimitiveTopology(VkPrimitiveTopology topology);
+void ignisSetDepthTest(uint8_t test, uint8_t write, VkCompareOp compareOp);
+
+/* need VK_EXT_extended_dynamic_state3, see IgnisDeviceFeatures */
+uint8_t ignisSetPolygonMode(VkPolygonMode mode);
+uint8_t ignisSetBlendEnable(uint8_t enable);
+
 uint8_t ignisBeginFrame();
 uint8_t ignisEndFrame();
 
-/* command buffers */
+/*
+ * Frames signal a timeline semaphore with increasing values once their
+ * commands completed. ignisGetFrameValue is the value of the frame that
+ * is currently recorded, anything used by it can be released as soon as
+ * ignisFrameComplete returns true for that value.
+ */
+uint64_t    ignisGetFrameValue();
+VkSemaphore ignisGetFrameSemaphore();
+
+uint8_t ignisFrameComplete(uint64_t value);
+void    ignisWaitFrame(uint64_t value);
+
+/*
+ * The frame's command buffer is begun by ignisBeginFrame. Work that has to
+ * run outside of rendering (e.g. compute dispatches) can be recorded into
+ * ignisGetCommandBuffer before ignisBeginCommandBuffer begins rendering.
+ */
+VkCommandBuffer ignisGetCommandBuffer();
 VkCommandBuffer ignisBeginCommandBuffer();
 void ignisEndCommandBuffer(VkCommandBuffer commandBuffer);
 
+/* records viewport, scissor and raster state, e.g. into secondary command buffers */
+void ignisRecordDynamicState(VkCommandBuffer commandBuffer);
+
+/*
+ * Suspends the current rendering and resumes it with the given contents,
+ * attachments are kept. Bound pipelines and descriptors are lost.
+ */
+void ignisContinueRendering(VkCommandBuffer commandBuffer, VkRenderingFlags flags);
+
 VkCommandBuffer ignisBeginOneTimeCommandBuffer();
 void ignisEndOneTimeCommandBuffer(VkCommandBuffer commandBuffer);
 
@@ -62,17 +165,33 @@ VkFormat ignisGetSwapchainImageFormat();
 VkFormat ignisGetSwapchainDepthFormat();
 
 VkExtent2D ignisGetSwapchainExtent();
+VkImage    ignisGetCurrentSwapchainImage();
+
+/*
+ * Headless contexts have no presentation engine, frames end in
+ * VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL and are read back from
+ * ignisGetCurrentSwapchainImage once their frame value completed.
+ */
+uint8_t ignisIsHeadless();
+
+const IgnisDeviceFeatures* ignisGetDeviceFeatures();
 
 float ignisGetMaxSamplerAnisotropy();
 
 uint32_t ignisGetCurrentFrame();
+uint32_t ignisGetFramesInFlight();
 uint32_t ignisGetQueueFamilyIndex(IgnisQueueFamily family);
+VkQueue  ignisGetQueue(IgnisQueueFamily family);
 
 float ignisGetAspectRatio();
 
 const VkAllocationCallbacks* ignisGetAllocator();
 
+uint32_t ignisGetMemoryHeapCount();
+IgnisMemoryHeapStats ignisGetMemoryHeapStats(uint32_t heap);
+
 
 void ignisPrintInfo();
+void ignisPrintMemoryStats();
 
 #endif /* IGNIS_CORE_H */
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "parallel.h"
+
+#include "thread.h"
+
+/* one slot per worker and one for the calling thread */
+#define IGNIS_MAX_RECORD_SLOTS (IGNIS_MAX_WORKERS + 1)
+
+typedef struct
+{
+    VkCommandPool pool;
+
+    /* secondary buffers are kept and reused after the pool is reset */
+    VkCommandBuffer* buffers;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t used;
+} IgnisRecordSlot;
+
+typedef struct
+{
+    VkCommandBuffer commandBuffer;
+    uint32_t first;
+    uint32_t count;
+    uint8_t taken;
+} IgnisRecordRange;
+
+static struct IgnisParallelRecorder
+{
+    IgnisRecordSlot slots[IGNIS_MAX_FRAMES_IN_FLIGHT][IGNIS_MAX_RECORD_SLOTS];
+    uint32_t slotCount;
+
+    IgnisMutex* mutex;
+    IgnisCondition* finished;
+
+    /* ranges of the current ignisRecordParallel, taken under the mutex */
+    IgnisRecordFunc func;
+    void* arg;
+    IgnisRecordRange ranges[IGNIS_MAX_RECORD_SLOTS];
+    uint32_t rangeCount;
+    uint32_t pending; /* ranges not recorded yet */
+} recorder;
+
+uint8_t ignisCreateParallelRecorder()
+{
+    memset(&recorder, 0, sizeof(recorder));
+
+    recorder.mutex = ignisCreateMutex();
+    recorder.finished = ignisCreateCondition();
+    if (!recorder.mutex || !recorder.finished)
+        return IGNIS_FAIL;
+
+    // pools are created on first use, so only frames in flight get one
+    recorder.slotCount = ignisGetWorkerCount() + 1;
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyParallelRecorder()
+{
+    for (uint32_t frame = 0; frame < IGNIS_MAX_FRAMES_IN_FLIGHT; ++frame)
+    {
+        for (uint32_t i = 0; i < recorder.slotCount; ++i)
+        {
+            IgnisRecordSlot* slot = &recorder.slots[frame][i];
+
+            // buffers are freed with their pool
+            vkDestroyCommandPool(ignisGetVkDevice(), slot->pool, ignisGetAllocator());
+            ignisFree(slot->buffers, sizeof(VkCommandBuffer) * slot->capacity);
+        }
+    }
+
+    ignisDestroyCondition(recorder.finished);
+    ignisDestroyMutex(recorder.mutex);
+
+    memset(&recorder, 0, sizeof(recorder));
+}
+
+void ignisResetParallelRecorder(uint32_t frame)
+{
+    for (uint32_t i = 0; i < recorder.slotCount; ++i)
+    {
+        IgnisRecordSlot* slot = &recorder.slots[frame][i];
+        if (!slot->used) continue;
+
+        vkResetCommandPool(ignisGetVkDevice(), slot->pool, 0);
+        slot->used = 0;
+    }
+}
+
+static VkCommandBuffer ignisAcquireSecondary(IgnisRecordSlot* slot)
+{
+    if (!slot->pool)
+    {
+        VkCommandPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = ignisGetQueueFamilyIndex(IGNIS_QUEUE_GRAPHICS)
+        };
+
+        if (vkCreateCommandPool(ignisGetVkDevice(), &poolInfo, ignisGetAllocator(), &slot->pool) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+    }
+
+    if (slot->used < slot->count)
+        return slot->buffers[slot->used++];
+
+    if (!ignisReserve((void**)&slot->buffers, &slot->capacity, slot->count + 1, sizeof(VkCommandBuffer)))
+        return VK_NULL_HANDLE;
+
+    VkCommandBufferAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandPool = slot->pool,
+        .commandBufferCount = 1
+    };
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(ignisGetVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+
+    slot->buffers[slot->count++] = commandBuffer;
+    slot->used++;
+
+    return commandBuffer;
+}
+
+static uint8_t ignisBeginSecondary(VkCommandBuffer commandBuffer, const IgnisRenderTarget* target)
+{
+    IgnisAttachmentFormats formats = {
+        .colorFormat = ignisGetSwapchainImageFormat(),
+        .depthFormat = ignisGetSwapchainDepthFormat(),
+        .samples = VK_SAMPLE_COUNT_1_BIT
+    };
+    VkRenderingFlags flags = VK_RENDERING_RESUMING_BIT | VK_RENDERING_SUSPENDING_BIT; /* as set by ignisContinueRendering */
+
+    if (target)
+    {
+        formats = ignisGetRenderTargetFormats(target);
+        flags = 0;
+    }
+
+    VkCommandBufferInheritanceRenderingInfo renderingInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+        .flags = flags,
+        .colorAttachmentCount = formats.colorFormat != VK_FORMAT_UNDEFINED ? 1 : 0,
+        .pColorAttachmentFormats = &formats.colorFormat,
+        .depthAttachmentFormat = formats.depthFormat,
+        .rasterizationSamples = formats.samples
+    };
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = &renderingInfo
+    };
+
+    VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        return IGNIS_FAIL;
+
+    if (target) ignisRecordRenderTargetState(commandBuffer, target);
+    else        ignisRecordDynamicState(commandBuffer);
+
+    return IGNIS_OK;
+}
+
+/* records ranges until every range is taken, called by workers and the calling thread */
+static void ignisRecordRanges()
+{
+    ignisLockMutex(recorder.mutex);
+    for (;;)
+    {
+        IgnisRecordRange* range = NULL;
+        for (uint32_t i = 0; i < recorder.rangeCount && !range; ++i)
+        {
+            if (!recorder.ranges[i].taken)
+                range = &recorder.ranges[i];
+        }
+
+        if (!range) break;
+
+        range->taken = 1;
+        IgnisRecordFunc func = recorder.func;
+        void* arg = recorder.arg;
+        ignisUnlockMutex(recorder.mutex);
+
+        for (uint32_t i = range->first; i < range->first + range->count; ++i)
+            func(range->commandBuffer, i, arg);
+
+        vkEndCommandBuffer(range->commandBuffer);
+
+        ignisLockMutex(recorder.mutex);
+        if (--recorder.pending == 0)
+            ignisSignalCondition(recorder.finished);
+    }
+    ignisUnlockMutex(recorder.mutex);
+}
+
+static void ignisRecordJob(void* arg)
+{
+    // jobs that start after the calling thread took every range find nothing left
+    ignisRecordRanges();
+}
+
+uint8_t ignisRecordParallel(VkCommandBuffer commandBuffer, const IgnisRenderTarget* target, uint32_t count, IgnisRecordFunc func, void* arg)
+{
+    if (!count) return IGNIS_OK;
+
+    uint32_t frame = ignisGetCurrentFrame();
+
+    uint32_t chunk = (count + recorder.slotCount - 1) / recorder.slotCount;
+    uint32_t rangeCount = (count + chunk - 1) / chunk;
+
+    VkCommandBuffer secondaries[IGNIS_MAX_RECORD_SLOTS];
+
+    // buffers are begun here, so the pools are only touched by one thread
+    for (uint32_t i = 0; i < rangeCount; ++i)
+    {
+        secondaries[i] = ignisAcquireSecondary(&recorder.slots[frame][i]);
+        if (!secondaries[i] || !ignisBeginSecondary(secondaries[i], target))
+        {
+            IGNIS_ERROR("failed to begin secondary command buffer");
+            return IGNIS_FAIL;
+        }
+    }
+
+    ignisLockMutex(recorder.mutex);
+    recorder.func = func;
+    recorder.arg = arg;
+    for (uint32_t i = 0; i < rangeCount; ++i)
+    {
+        recorder.ranges[i] = (IgnisRecordRange){
+            .commandBuffer = secondaries[i],
+            .first = i * chunk,
+            .count = (i + 1) * chunk < count ? chunk : count - i * chunk,
+            .taken = 0
+        };
+    }
+    recorder.rangeCount = rangeCount;
+    recorder.pending = rangeCount;
+    ignisUnlockMutex(recorder.mutex);
+
+    // queued in front of pipeline jobs, so the frame does not wait behind them
+    for (uint32_t i = 1; i < rangeCount; ++i)
+        ignisSubmitPriorityJob(ignisRecordJob, NULL);
+
+    // the calling thread records every range no worker took yet
+    ignisRecordRanges();
+
+    ignisLockMutex(recorder.mutex);
+    while (recorder.pending)
+        ignisWaitCondition(recorder.finished, recorder.mutex);
+    ignisUnlockMutex(recorder.mutex);
+
+    if (target)
+    {
+        vkCmdExecuteCommands(commandBuffer, rangeCount, secondaries);
+        return IGNIS_OK;
+    }
+
+    ignisContinueRendering(commandBuffer, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT);
+    vkCmdExecuteCommands(commandBuffer, rangeCount, secondaries);
+    ignisContinueRendering(commandBuffer, 0);
+
+    return IGNIS_OK;
+}
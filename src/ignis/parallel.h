@@ -0,0 +1,41 @@
+#ifndef IGNIS_PARALLEL_H
+#define IGNIS_PARALLEL_H
+
+#include "ignis_core.h"
+
+#include "render_target.h"
+
+/*
+ * Records draw lists in parallel on the worker pool. Every range has its
+ * own command pool per frame in flight, so recording needs no locking.
+ * Pools are reset once the frame that used them completed.
+ *
+ * ignisRecordParallel splits count draw lists into contiguous ranges, each
+ * range is recorded into a secondary command buffer that inherits the
+ * rendering and starts with the current dynamic state. The buffers are
+ * executed in order from the primary command buffer. Ranges are queued in
+ * front of other jobs, the calling thread records every range no worker
+ * has taken yet instead of waiting for it.
+ *
+ * Record functions run concurrently: they must not call ignisSet* state
+ * functions or bind textures on a pipeline shared with another range.
+ * After ignisSetFramesInFlight pipelines grow their descriptor sets on
+ * first use, which has to happen outside of parallel recording.
+ * Pipelines bound before ignisRecordParallel have to be rebound after it.
+ */
+typedef void (*IgnisRecordFunc)(VkCommandBuffer commandBuffer, uint32_t index, void* arg);
+
+uint8_t ignisCreateParallelRecorder();
+void ignisDestroyParallelRecorder();
+
+void ignisResetParallelRecorder(uint32_t frame);
+
+/*
+ * Without a target the ranges continue the frame's rendering, between
+ * ignisBeginCommandBuffer and ignisEndCommandBuffer. With a target they are
+ * recorded with its formats and extent, inside ignisBeginRenderTarget with
+ * VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT.
+ */
+uint8_t ignisRecordParallel(VkCommandBuffer commandBuffer, const IgnisRenderTarget* target, uint32_t count, IgnisRecordFunc func, void* arg);
+
+#endif /* !IGNIS_PARALLEL_H */
@@ -1,6 +1,12 @@
 #include "pipeline.h"
 
 #include "ignis.h"
+#include "frame_allocator.h"
+#include "bindless.h"
+#include "pipeline_cache.h"
+#include "pipeline_registry.h"
+#include "thread.h"
+#include "deletion_queue.h"
 
 
 VkShaderModule ignisCreateShaderModule(const char* path)
@@ -10,6 +16,7 @@ VkShaderModule ignisCreateShaderModule(const char* path)
 
     size_t size;
     char* code = ignisReadFile(path, &size);
+    if (!code) return VK_NULL_HANDLE;
 
     VkShaderModuleCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
@@ -20,10 +27,15 @@ VkShaderModule ignisCreateShaderModule(const char* path)
     VkShaderModule module;
     VkResult result = vkCreateShaderModule(device, &info, allocator, &module);
 
+    // modules are identified by their code when pipelines are shared
+    uint64_t hash = ignisHashBytes(code, info.codeSize, IGNIS_HASH_SEED);
+
     ignisFree(code, size);
 
     if (result != VK_SUCCESS) return VK_NULL_HANDLE;
 
+    ignisRegisterShaderModule(module, hash);
+
     return module;
 }
 
@@ -32,58 +44,453 @@ void ignisDestroyShaderModule(VkShaderModule shader)
     VkDevice device = ignisGetVkDevice();
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
+    ignisUnregisterShaderModule(shader);
     vkDestroyShaderModule(device, shader, allocator);
 }
 
-uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule vert, VkShaderModule frag, IgnisPipeline* pipeline)
+/* --------------------------| shared state |---------------------------- */
+#define IGNIS_PIPELINE_KEY_SIZE 1024
+#define IGNIS_MAX_DYNAMIC_STATES 16
+
+/* state an object is created from, objects with equal keys are shared */
+typedef struct
 {
-    if (!vert || !frag)
+    uint8_t data[IGNIS_PIPELINE_KEY_SIZE];
+    size_t size;
+    uint8_t valid; /* too big or unknown state, the object is not shared */
+} IgnisPipelineKey;
+
+static void ignisKeyAppend(IgnisPipelineKey* key, const void* data, size_t size)
+{
+    if (key->size + size > IGNIS_PIPELINE_KEY_SIZE)
     {
-        IGNIS_ERROR("At least one shader module is missing");
+        key->valid = 0;
+        return;
+    }
+
+    if (size) memcpy(key->data + key->size, data, size);
+    key->size += size;
+}
+
+static uint8_t ignisAcquireSetLayout(const VkDescriptorSetLayoutCreateInfo* info, VkDescriptorSetLayout* layout)
+{
+    IgnisPipelineKey key = { .valid = 1 };
+    ignisKeyAppend(&key, &info->flags, sizeof(info->flags));
+    ignisKeyAppend(&key, info->pBindings, sizeof(VkDescriptorSetLayoutBinding) * info->bindingCount);
+
+    IgnisRegistryHandle handle;
+    if (key.valid && ignisRegistryFind(IGNIS_REGISTRY_SET_LAYOUT, key.data, key.size, &handle))
+    {
+        *layout = handle.setLayout;
+        return IGNIS_OK;
+    }
+
+    if (vkCreateDescriptorSetLayout(ignisGetVkDevice(), info, ignisGetAllocator(), &handle.setLayout) != VK_SUCCESS)
         return IGNIS_FAIL;
+
+    VkDescriptorSetLayout created = handle.setLayout;
+    if (key.valid && !ignisRegistryInsert(IGNIS_REGISTRY_SET_LAYOUT, key.data, key.size, &handle))
+        vkDestroyDescriptorSetLayout(ignisGetVkDevice(), created, ignisGetAllocator());
+
+    *layout = handle.setLayout;
+    return IGNIS_OK;
+}
+
+static void ignisReleaseSetLayout(VkDescriptorSetLayout layout)
+{
+    IgnisRegistryHandle handle = { .setLayout = layout };
+    if (layout && ignisRegistryRelease(IGNIS_REGISTRY_SET_LAYOUT, handle))
+        vkDestroyDescriptorSetLayout(ignisGetVkDevice(), layout, ignisGetAllocator());
+}
+
+static uint8_t ignisAcquirePipelineLayout(const VkPipelineLayoutCreateInfo* info, VkPipelineLayout* layout)
+{
+    // set layouts are shared, so their handles identify them
+    IgnisPipelineKey key = { .valid = 1 };
+    ignisKeyAppend(&key, &info->setLayoutCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, info->pSetLayouts, sizeof(VkDescriptorSetLayout) * info->setLayoutCount);
+    ignisKeyAppend(&key, &info->pushConstantRangeCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, info->pPushConstantRanges, sizeof(VkPushConstantRange) * info->pushConstantRangeCount);
+
+    IgnisRegistryHandle handle;
+    if (key.valid && ignisRegistryFind(IGNIS_REGISTRY_PIPELINE_LAYOUT, key.data, key.size, &handle))
+    {
+        *layout = handle.pipelineLayout;
+        return IGNIS_OK;
     }
 
-    VkDevice device = ignisGetVkDevice();
-    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+    if (vkCreatePipelineLayout(ignisGetVkDevice(), info, ignisGetAllocator(), &handle.pipelineLayout) != VK_SUCCESS)
+        return IGNIS_FAIL;
 
-    /* descriptor layout */
-    VkDescriptorSetLayoutBinding descriptorBindings[] = {
-        {
-            .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-            .pImmutableSamplers = NULL
-        },
-        {
-            .binding = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .pImmutableSamplers = NULL
-        }
+    VkPipelineLayout created = handle.pipelineLayout;
+    if (key.valid && !ignisRegistryInsert(IGNIS_REGISTRY_PIPELINE_LAYOUT, key.data, key.size, &handle))
+        vkDestroyPipelineLayout(ignisGetVkDevice(), created, ignisGetAllocator());
+
+    *layout = handle.pipelineLayout;
+    return IGNIS_OK;
+}
+
+static void ignisReleasePipelineLayout(VkPipelineLayout layout)
+{
+    IgnisRegistryHandle handle = { .pipelineLayout = layout };
+    if (layout && ignisRegistryRelease(IGNIS_REGISTRY_PIPELINE_LAYOUT, handle))
+        vkDestroyPipelineLayout(ignisGetVkDevice(), layout, ignisGetAllocator());
+}
+
+/* registers a newly created pipeline, returns the pipeline to use */
+static VkPipeline ignisSharePipeline(const IgnisPipelineKey* key, VkPipeline pipeline)
+{
+    IgnisRegistryHandle handle = { .pipeline = pipeline };
+    if (key->valid && !ignisRegistryInsert(IGNIS_REGISTRY_PIPELINE, key->data, key->size, &handle))
+        vkDestroyPipeline(ignisGetVkDevice(), pipeline, ignisGetAllocator());
+
+    return handle.pipeline;
+}
+
+static void ignisReleasePipeline(VkPipeline pipeline)
+{
+    IgnisRegistryHandle handle = { .pipeline = pipeline };
+    if (pipeline && ignisRegistryRelease(IGNIS_REGISTRY_PIPELINE, handle))
+        vkDestroyPipeline(ignisGetVkDevice(), pipeline, ignisGetAllocator());
+}
+
+/* --------------------------| pipeline libraries |---------------------- */
+struct IgnisPipelineLink
+{
+    VkPipeline libraries[IGNIS_PIPELINE_LIBRARY_COUNT];
+    VkPipelineLayout layout;
+
+    IgnisMutex* mutex;
+
+    VkPipeline optimized;
+    uint8_t done;
+    uint8_t cancelled; /* the pipeline is destroyed, the job cleans up */
+};
+
+static uint8_t ignisCreatePipelineLibrary(const VkGraphicsPipelineCreateInfo* info, VkGraphicsPipelineLibraryFlagsEXT part, const IgnisPipelineKey* key, VkPipeline* library)
+{
+    IgnisRegistryHandle handle;
+    if (key->valid && ignisRegistryFind(IGNIS_REGISTRY_PIPELINE, key->data, key->size, &handle))
+    {
+        *library = handle.pipeline;
+        return IGNIS_OK;
+    }
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = info->pNext,
+        .flags = part
     };
 
-    uint32_t bindingCount = sizeof(descriptorBindings) / sizeof(VkDescriptorSetLayoutBinding);
+    VkGraphicsPipelineCreateInfo libraryPipelineInfo = *info;
+    libraryPipelineInfo.pNext = &libraryInfo;
+    libraryPipelineInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = bindingCount,
-        .pBindings = descriptorBindings
+    VkResult result = vkCreateGraphicsPipelines(ignisGetVkDevice(), ignisGetPipelineCache(), 1, &libraryPipelineInfo, ignisGetAllocator(), library);
+    if (result != VK_SUCCESS)
+        return IGNIS_FAIL;
+
+    *library = ignisSharePipeline(key, *library);
+    return IGNIS_OK;
+}
+
+static void ignisReleasePipelineLibraries(VkPipeline* libraries)
+{
+    for (uint32_t i = 0; i < IGNIS_PIPELINE_LIBRARY_COUNT; ++i)
+    {
+        ignisReleasePipeline(libraries[i]);
+        libraries[i] = VK_NULL_HANDLE;
+    }
+}
+
+static void ignisFreePipelineLink(IgnisPipelineLink* link)
+{
+    ignisDestroyMutex(link->mutex);
+    ignisFree(link, sizeof(IgnisPipelineLink));
+}
+
+static void ignisOptimizePipeline(void* arg)
+{
+    IgnisPipelineLink* link = arg;
+
+    VkPipelineCreationFeedback feedback = { 0 };
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pPipelineCreationFeedback = &feedback
+    };
+
+    VkPipelineLibraryCreateInfoKHR libraryInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .pNext = &feedbackInfo,
+        .libraryCount = IGNIS_PIPELINE_LIBRARY_COUNT,
+        .pLibraries = link->libraries
+    };
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .flags = VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT,
+        .layout = link->layout
+    };
+
+    VkPipeline optimized = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(ignisGetVkDevice(), ignisGetPipelineCache(), 1, &pipelineInfo, ignisGetAllocator(), &optimized) == VK_SUCCESS)
+        ignisRecordPipelineFeedback(&feedback);
+    else
+        IGNIS_WARN("failed to optimize pipeline, keeping the fast linked one");
+
+    // the job's own reference, the pipeline may have released its layout already
+    ignisReleasePipelineLayout(link->layout);
+
+    ignisLockMutex(link->mutex);
+    uint8_t cancelled = link->cancelled;
+    link->optimized = optimized;
+    link->done = 1;
+    ignisUnlockMutex(link->mutex);
+
+    // the pipeline was destroyed in the meantime and left its libraries to this job
+    if (cancelled)
+    {
+        vkDestroyPipeline(ignisGetVkDevice(), optimized, ignisGetAllocator());
+        ignisReleasePipelineLibraries(link->libraries);
+        ignisFreePipelineLink(link);
+    }
+}
+
+/*
+ * Splits the pipeline into vertex input, pre-rasterization, fragment shader
+ * and fragment output libraries. Libraries are shared through the registry,
+ * so new combinations only compile the parts that changed. The libraries
+ * are fast linked right away, the optimized link is done on a worker.
+ */
+static uint8_t ignisLinkPipeline(const VkGraphicsPipelineCreateInfo* info, IgnisPipeline* pipeline)
+{
+    const VkPipelineVertexInputStateCreateInfo* vertexInput = info->pVertexInputState;
+    const VkPipelineRasterizationStateCreateInfo* rasterizer = info->pRasterizationState;
+    const VkPipelineDepthStencilStateCreateInfo* depthStencil = info->pDepthStencilState;
+    const VkPipelineColorBlendStateCreateInfo* colorBlending = info->pColorBlendState;
+    const VkPipelineDynamicStateCreateInfo* dynamicState = info->pDynamicState;
+    const VkPipelineRenderingCreateInfo* rendering = info->pNext;
+
+    uint64_t vertHash = ignisGetShaderModuleHash(info->pStages[0].module);
+    uint64_t fragHash = ignisGetShaderModuleHash(info->pStages[1].module);
+
+    /* vertex input */
+    VkGraphicsPipelineLibraryFlagsEXT part = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+
+    IgnisPipelineKey key = { .valid = 1 };
+    ignisKeyAppend(&key, &part, sizeof(part));
+    ignisKeyAppend(&key, &vertexInput->vertexBindingDescriptionCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, vertexInput->pVertexBindingDescriptions, sizeof(VkVertexInputBindingDescription) * vertexInput->vertexBindingDescriptionCount);
+    ignisKeyAppend(&key, &vertexInput->vertexAttributeDescriptionCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, vertexInput->pVertexAttributeDescriptions, sizeof(VkVertexInputAttributeDescription) * vertexInput->vertexAttributeDescriptionCount);
+    ignisKeyAppend(&key, &info->pInputAssemblyState->topology, sizeof(VkPrimitiveTopology));
+
+    VkGraphicsPipelineCreateInfo partInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pVertexInputState = info->pVertexInputState,
+        .pInputAssemblyState = info->pInputAssemblyState,
+        .pDynamicState = info->pDynamicState
+    };
+
+    if (!ignisCreatePipelineLibrary(&partInfo, part, &key, &pipeline->libraries[0]))
+    {
+        ignisReleasePipelineLibraries(pipeline->libraries);
+        return IGNIS_FAIL;
+    }
+
+    /* pre-rasterization */
+    part = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+
+    key = (IgnisPipelineKey){ .valid = vertHash != 0 };
+    ignisKeyAppend(&key, &part, sizeof(part));
+    ignisKeyAppend(&key, &info->layout, sizeof(VkPipelineLayout));
+    ignisKeyAppend(&key, &vertHash, sizeof(uint64_t));
+    ignisKeyAppend(&key, &rasterizer->polygonMode, sizeof(VkPolygonMode));
+    ignisKeyAppend(&key, &rasterizer->cullMode, sizeof(VkCullModeFlags));
+    ignisKeyAppend(&key, &rasterizer->frontFace, sizeof(VkFrontFace));
+    ignisKeyAppend(&key, &dynamicState->dynamicStateCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, dynamicState->pDynamicStates, sizeof(VkDynamicState) * dynamicState->dynamicStateCount);
+
+    partInfo = (VkGraphicsPipelineCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = rendering,
+        .stageCount = 1,
+        .pStages = &info->pStages[0],
+        .pViewportState = info->pViewportState,
+        .pRasterizationState = info->pRasterizationState,
+        .pDynamicState = info->pDynamicState,
+        .layout = info->layout
     };
 
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, allocator, &pipeline->descriptorSetLayout) != VK_SUCCESS)
+    if (!ignisCreatePipelineLibrary(&partInfo, part, &key, &pipeline->libraries[1]))
+    {
+        ignisReleasePipelineLibraries(pipeline->libraries);
         return IGNIS_FAIL;
+    }
+
+    /* fragment shader */
+    part = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+
+    key = (IgnisPipelineKey){ .valid = fragHash != 0 };
+    ignisKeyAppend(&key, &part, sizeof(part));
+    ignisKeyAppend(&key, &info->layout, sizeof(VkPipelineLayout));
+    ignisKeyAppend(&key, &fragHash, sizeof(uint64_t));
+    ignisKeyAppend(&key, &depthStencil->depthTestEnable, sizeof(VkBool32));
+    ignisKeyAppend(&key, &depthStencil->depthWriteEnable, sizeof(VkBool32));
+    ignisKeyAppend(&key, &depthStencil->depthCompareOp, sizeof(VkCompareOp));
+    ignisKeyAppend(&key, &info->pMultisampleState->rasterizationSamples, sizeof(VkSampleCountFlagBits));
+
+    partInfo = (VkGraphicsPipelineCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = rendering,
+        .stageCount = 1,
+        .pStages = &info->pStages[1],
+        .pMultisampleState = info->pMultisampleState,
+        .pDepthStencilState = info->pDepthStencilState,
+        .pDynamicState = info->pDynamicState,
+        .layout = info->layout
+    };
+
+    if (!ignisCreatePipelineLibrary(&partInfo, part, &key, &pipeline->libraries[2]))
+    {
+        ignisReleasePipelineLibraries(pipeline->libraries);
+        return IGNIS_FAIL;
+    }
+
+    /* fragment output */
+    part = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+    key = (IgnisPipelineKey){ .valid = 1 };
+    ignisKeyAppend(&key, &part, sizeof(part));
+    ignisKeyAppend(&key, &rendering->colorAttachmentCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, rendering->pColorAttachmentFormats, sizeof(VkFormat) * rendering->colorAttachmentCount);
+    ignisKeyAppend(&key, &rendering->depthAttachmentFormat, sizeof(VkFormat));
+    ignisKeyAppend(&key, &info->pMultisampleState->rasterizationSamples, sizeof(VkSampleCountFlagBits));
+    ignisKeyAppend(&key, colorBlending->pAttachments, sizeof(VkPipelineColorBlendAttachmentState) * colorBlending->attachmentCount);
+
+    partInfo = (VkGraphicsPipelineCreateInfo){
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = rendering,
+        .pMultisampleState = info->pMultisampleState,
+        .pColorBlendState = info->pColorBlendState,
+        .pDynamicState = info->pDynamicState
+    };
+
+    if (!ignisCreatePipelineLibrary(&partInfo, part, &key, &pipeline->libraries[3]))
+    {
+        ignisReleasePipelineLibraries(pipeline->libraries);
+        return IGNIS_FAIL;
+    }
+
+    /* fast link */
+    VkPipelineLibraryCreateInfoKHR libraryInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .libraryCount = IGNIS_PIPELINE_LIBRARY_COUNT,
+        .pLibraries = pipeline->libraries
+    };
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryInfo,
+        .layout = info->layout
+    };
+
+    if (vkCreateGraphicsPipelines(ignisGetVkDevice(), ignisGetPipelineCache(), 1, &pipelineInfo, ignisGetAllocator(), &pipeline->handle) != VK_SUCCESS)
+    {
+        ignisReleasePipelineLibraries(pipeline->libraries);
+        return IGNIS_FAIL;
+    }
+
+    /* optimized link */
+    IgnisPipelineLink* link = ignisAlloc(sizeof(IgnisPipelineLink));
+    if (!link) return IGNIS_OK;
+
+    memset(link, 0, sizeof(IgnisPipelineLink));
+    memcpy(link->libraries, pipeline->libraries, sizeof(link->libraries));
+    link->layout = info->layout;
+    link->mutex = ignisCreateMutex();
+
+    // the job keeps the layout alive, unshared layouts are not linked in the background
+    IgnisRegistryHandle layout = { .pipelineLayout = link->layout };
+    if (!link->mutex || !ignisRegistryRetain(IGNIS_REGISTRY_PIPELINE_LAYOUT, layout))
+    {
+        ignisFreePipelineLink(link);
+        return IGNIS_OK;
+    }
+
+    if (!ignisSubmitJob(ignisOptimizePipeline, link))
+    {
+        ignisReleasePipelineLayout(link->layout);
+        ignisFreePipelineLink(link);
+        return IGNIS_OK;
+    }
+
+    pipeline->link = link;
+
+    return IGNIS_OK;
+}
+
+/* the optimized pipeline once it is ready, the fast linked one until then */
+static VkPipeline ignisGetLinkedPipeline(const IgnisPipeline* pipeline)
+{
+    IgnisPipelineLink* link = pipeline->link;
+
+    ignisLockMutex(link->mutex);
+    VkPipeline handle = link->optimized ? link->optimized : pipeline->handle;
+    ignisUnlockMutex(link->mutex);
+
+    return handle;
+}
+
+/* returns 0 if the link is destroyed, 1 if a pending job takes over the libraries */
+static uint8_t ignisDestroyPipelineLink(IgnisPipelineLink* link)
+{
+    // never wait for the job, it drops its result once it is done
+    ignisLockMutex(link->mutex);
+    uint8_t pending = !link->done;
+    link->cancelled = pending;
+    ignisUnlockMutex(link->mutex);
+
+    if (pending) return 1;
+
+    vkDestroyPipeline(ignisGetVkDevice(), link->optimized, ignisGetAllocator());
+    ignisFreePipelineLink(link);
+
+    return 0;
+}
+
+/* --------------------------| descriptor sets |------------------------- */
+static void ignisFreePipelineSets(IgnisPipeline* pipeline)
+{
+    vkDestroyDescriptorPool(ignisGetVkDevice(), pipeline->descriptorPool, ignisGetAllocator());
+
+    ignisFree(pipeline->descriptorSets, sizeof(VkDescriptorSet) * pipeline->frameCount);
+    ignisFree(pipeline->boundTextures, sizeof(uint32_t) * pipeline->frameCount);
+
+    pipeline->descriptorPool = VK_NULL_HANDLE;
+    pipeline->descriptorSets = NULL;
+    pipeline->boundTextures = NULL;
+    pipeline->frameCount = 0;
+}
+
+/*
+ * One set for every possible frame in flight, like compute pipelines, so
+ * changing the number of frames never reallocates sets while other threads
+ * record with them.
+ */
+static uint8_t ignisAllocatePipelineSets(IgnisPipeline* pipeline, uint32_t frameCount)
+{
+    VkDevice device = ignisGetVkDevice();
 
-    /* descriptor pool */
     VkDescriptorPoolSize poolSizes[] = {
         {
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = IGNIS_MAX_FRAMES_IN_FLIGHT
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = frameCount
         },
         {
             .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = IGNIS_MAX_FRAMES_IN_FLIGHT
+            .descriptorCount = frameCount
         }
     };
 
@@ -93,26 +500,26 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
         .poolSizeCount = poolSizeCount,
         .pPoolSizes = poolSizes,
-        .maxSets = IGNIS_MAX_FRAMES_IN_FLIGHT
+        .maxSets = frameCount
     };
 
-    /* uniform buffer */
-    pipeline->uniformBufferSize = config->uniformBufferSize;
-
-    for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    if (vkCreateDescriptorPool(device, &poolInfo, ignisGetAllocator(), &pipeline->descriptorPool) != VK_SUCCESS)
     {
-        ignisCreateBuffer(NULL, pipeline->uniformBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &pipeline->uniformBuffers[i]);
-        vkMapMemory(device, pipeline->uniformBuffers[i].memory, 0, pipeline->uniformBufferSize, 0, &pipeline->uniformBufferData[i]);
+        IGNIS_ERROR("failed to create descriptor pool!");
+        return IGNIS_FAIL;
     }
 
-    if (vkCreateDescriptorPool(device, &poolInfo, allocator, &pipeline->descriptorPool) != VK_SUCCESS)
+    pipeline->descriptorSets = ignisAlloc(sizeof(VkDescriptorSet) * frameCount);
+    pipeline->boundTextures = ignisAlloc(sizeof(uint32_t) * frameCount);
+    pipeline->frameCount = frameCount;
+
+    if (!pipeline->descriptorSets || !pipeline->boundTextures)
     {
-        IGNIS_ERROR("failed to create descriptor pool!");
+        IGNIS_ERROR("failed to allocate descriptor sets!");
         return IGNIS_FAIL;
     }
 
-    /* descriptor sets */
-    for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+    for (size_t i = 0; i < frameCount; ++i)
     {
         VkDescriptorSetAllocateInfo allocInfo = {
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -121,14 +528,19 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
             .pSetLayouts = &pipeline->descriptorSetLayout
         };
 
-        if (vkAllocateDescriptorSets(device, &allocInfo, &pipeline->descriptorSets[i]) != VK_SUCCESS) {
+        if (vkAllocateDescriptorSets(device, &allocInfo, &pipeline->descriptorSets[i]) != VK_SUCCESS)
+        {
             IGNIS_ERROR("failed to allocate descriptor sets!");
+            return IGNIS_FAIL;
         }
 
+        pipeline->boundTextures[i] = 0;
+
+        // the frame slice is selected with a dynamic offset
         VkDescriptorBufferInfo bufferInfo = {
-            .buffer = pipeline->uniformBuffers[i].handle,
+            .buffer = ignisGetFrameAllocatorBuffer(),
             .offset = 0,
-            .range = VK_WHOLE_SIZE
+            .range = pipeline->uniformBufferSize
         };
 
         VkWriteDescriptorSet descriptorWrite = {
@@ -136,7 +548,7 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
             .dstSet = pipeline->descriptorSets[i],
             .dstBinding = 0,
             .dstArrayElement = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             .descriptorCount = 1,
             .pBufferInfo = &bufferInfo
         };
@@ -144,16 +556,143 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, NULL);
     }
 
-    /* layout */
+    return IGNIS_OK;
+}
+
+/* undoes a partially created pipeline, nothing of it was used by the device yet */
+static void ignisDiscardPipeline(IgnisPipeline* pipeline)
+{
+    ignisReleasePipelineLayout(pipeline->layout);
+    ignisFreePipelineSets(pipeline);
+    ignisReleaseSetLayout(pipeline->descriptorSetLayout);
+
+    ignisFree(pipeline->uniformData, pipeline->uniformBufferSize);
+    pipeline->uniformData = NULL;
+}
+
+uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule vert, VkShaderModule frag, IgnisPipeline* pipeline)
+{
+    if (!vert || !frag)
+    {
+        IGNIS_ERROR("At least one shader module is missing");
+        return IGNIS_FAIL;
+    }
+
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    /* descriptor layout */
+    VkDescriptorSetLayoutBinding descriptorBindings[] = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .pImmutableSamplers = NULL
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = NULL
+        }
+    };
+
+    uint32_t bindingCount = sizeof(descriptorBindings) / sizeof(VkDescriptorSetLayoutBinding);
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = bindingCount,
+        .pBindings = descriptorBindings
+    };
+
+    pipeline->layout = VK_NULL_HANDLE;
+    pipeline->descriptorPool = VK_NULL_HANDLE;
+    pipeline->descriptorSets = NULL;
+    pipeline->boundTextures = NULL;
+    pipeline->frameCount = 0;
+    pipeline->uniformData = NULL;
+    pipeline->uniformBufferSize = 0;
+
+    if (!ignisAcquireSetLayout(&layoutInfo, &pipeline->descriptorSetLayout))
+        return IGNIS_FAIL;
+
+    /* uniform buffer */
+    pipeline->uniformBufferSize = config->uniformBufferSize;
+
+    pipeline->uniformData = ignisAlloc(pipeline->uniformBufferSize);
+    if (!pipeline->uniformData)
+    {
+        IGNIS_ERROR("failed to allocate uniform data!");
+        ignisDiscardPipeline(pipeline);
+        return IGNIS_FAIL;
+    }
+
+    memset(pipeline->uniformData, 0, pipeline->uniformBufferSize);
+
+    /* descriptor sets */
+    if (!ignisAllocatePipelineSets(pipeline, IGNIS_MAX_FRAMES_IN_FLIGHT))
+    {
+        ignisDiscardPipeline(pipeline);
+        return IGNIS_FAIL;
+    }
+
+    /* layout, set 1 is the bindless texture table */
+    VkDescriptorSetLayout setLayouts[] = {
+        pipeline->descriptorSetLayout,
+        ignisGetBindlessSetLayout()
+    };
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount = 1,
-        .pSetLayouts = &pipeline->descriptorSetLayout,
-        .pushConstantRangeCount = 0,
+        .setLayoutCount = sizeof(setLayouts) / sizeof(setLayouts[0]),
+        .pSetLayouts = setLayouts,
+        .pushConstantRangeCount = config->pushConstantRangeCount,
+        .pPushConstantRanges = config->pushConstantRanges
     };
 
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, allocator, &pipeline->layout) != VK_SUCCESS)
+    if (!ignisAcquirePipelineLayout(&pipelineLayoutInfo, &pipeline->layout))
+    {
+        ignisDiscardPipeline(pipeline);
         return IGNIS_FAIL;
+    }
+
+    pipeline->link = NULL;
+    memset(pipeline->libraries, 0, sizeof(pipeline->libraries));
+
+    uint8_t useLibraries = ignisGetDeviceFeatures()->graphicsPipelineLibrary;
+
+    IgnisAttachmentFormats attachments = config->attachments;
+    if (attachments.samples == 0)
+    {
+        attachments.colorFormat = ignisGetSwapchainImageFormat();
+        attachments.depthFormat = ignisGetSwapchainDepthFormat();
+        attachments.samples = VK_SAMPLE_COUNT_1_BIT;
+    }
+
+    /* reuse an equal pipeline */
+    VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    uint64_t shaderHashes[] = { ignisGetShaderModuleHash(vert), ignisGetShaderModuleHash(frag) };
+    uint32_t attributeCount = (uint32_t)config->attributeCount;
+
+    IgnisPipelineKey key = { .valid = shaderHashes[0] && shaderHashes[1] };
+    ignisKeyAppend(&key, &bindPoint, sizeof(VkPipelineBindPoint));
+    ignisKeyAppend(&key, &pipeline->layout, sizeof(VkPipelineLayout));
+    ignisKeyAppend(&key, shaderHashes, sizeof(shaderHashes));
+    ignisKeyAppend(&key, &attachments, sizeof(IgnisAttachmentFormats));
+    ignisKeyAppend(&key, &config->vertexStride, sizeof(uint32_t));
+    ignisKeyAppend(&key, &config->vertexBindingCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, config->vertexBindings, sizeof(VkVertexInputBindingDescription) * config->vertexBindingCount);
+    ignisKeyAppend(&key, &attributeCount, sizeof(uint32_t));
+    ignisKeyAppend(&key, config->vertexAttributes, sizeof(VkVertexInputAttributeDescription) * attributeCount);
+
+    IgnisRegistryHandle shared;
+    if (!useLibraries && key.valid && ignisRegistryFind(IGNIS_REGISTRY_PIPELINE, key.data, key.size, &shared))
+    {
+        pipeline->handle = shared.pipeline;
+        return IGNIS_OK;
+    }
 
     /* shader stages */
     VkPipelineShaderStageCreateInfo shaderStages[] = {
@@ -178,10 +717,18 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
     };
 
+    const VkVertexInputBindingDescription* bindings = &bindingDescription;
+    uint32_t bindingCount = 1;
+    if (config->vertexBindingCount)
+    {
+        bindings = config->vertexBindings;
+        bindingCount = config->vertexBindingCount;
+    }
+
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
+        .vertexBindingDescriptionCount = bindingCount,
+        .pVertexBindingDescriptions = bindings,
         .vertexAttributeDescriptionCount = config->attributeCount,
         .pVertexAttributeDescriptions = config->vertexAttributes
     };
@@ -200,15 +747,15 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .scissorCount = 1
     };
 
-    /* rasterization */
+    /* rasterization, cull mode and front face are dynamic */
     VkPipelineRasterizationStateCreateInfo rasterizer = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
         .depthClampEnable = VK_FALSE,
         .rasterizerDiscardEnable = VK_FALSE,
         .polygonMode = VK_POLYGON_MODE_FILL,
         .lineWidth = 1.0f,
-        .cullMode = config->cullMode,
-        .frontFace = config->frontFace,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
         .depthBiasEnable = VK_FALSE
     };
 
@@ -216,10 +763,10 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
     VkPipelineMultisampleStateCreateInfo multisampling = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
         .sampleShadingEnable = VK_FALSE,
-        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        .rasterizationSamples = attachments.samples
     };
 
-    /* depth stencil */
+    /* depth stencil, test, write and compare op are dynamic */
     VkPipelineDepthStencilStateCreateInfo depthStencil = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
         .depthTestEnable = VK_TRUE,
@@ -229,7 +776,9 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .stencilTestEnable = VK_FALSE
     };
 
-    /* color blending */
+    /* color blending, depth only targets have no color attachment */
+    uint32_t colorCount = attachments.colorFormat != VK_FORMAT_UNDEFINED ? 1 : 0;
+
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {
         .colorWriteMask = VK_COLOR_COMPONENT_R_BIT
                         | VK_COLOR_COMPONENT_G_BIT
@@ -248,7 +797,7 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
         .logicOpEnable = VK_FALSE,
         .logicOp = VK_LOGIC_OP_COPY,
-        .attachmentCount = 1,
+        .attachmentCount = colorCount,
         .pAttachments = &colorBlendAttachment,
         .blendConstants[0] = 0.0f,
         .blendConstants[1] = 0.0f,
@@ -256,26 +805,41 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .blendConstants[3] = 0.0f
     };
 
-    /* dynamic states */
-    VkDynamicState dynamicStates[] = {
+    /* dynamic states, set by ignisBeginCommandBuffer */
+    VkDynamicState dynamicStates[IGNIS_MAX_DYNAMIC_STATES] = {
         VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
+        VK_DYNAMIC_STATE_SCISSOR,
+        VK_DYNAMIC_STATE_CULL_MODE,
+        VK_DYNAMIC_STATE_FRONT_FACE,
+        VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+        VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+        VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+        VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
     };
+    uint32_t dynamicStateCount = 8;
+
+    const IgnisDeviceFeatures* features = ignisGetDeviceFeatures();
+    if (features->dynamicPolygonMode) dynamicStates[dynamicStateCount++] = VK_DYNAMIC_STATE_POLYGON_MODE_EXT;
+    if (features->dynamicBlendEnable) dynamicStates[dynamicStateCount++] = VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT;
 
     VkPipelineDynamicStateCreateInfo dynamicStateInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-        .dynamicStateCount = sizeof(dynamicStates) / sizeof(dynamicStates[0]),
+        .dynamicStateCount = dynamicStateCount,
         .pDynamicStates = dynamicStates
     };
 
-    VkFormat imageFormat = ignisGetSwapchainImageFormat();
-    VkFormat depthFormat = ignisGetSwapchainDepthFormat();
+    VkPipelineCreationFeedback feedback = { 0 };
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pPipelineCreationFeedback = &feedback
+    };
 
     VkPipelineRenderingCreateInfo pipelineRenderingInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR,
-        .colorAttachmentCount = 1,
-        .pColorAttachmentFormats = &imageFormat,
-        .depthAttachmentFormat = depthFormat
+        .pNext = &feedbackInfo,
+        .colorAttachmentCount = colorCount,
+        .pColorAttachmentFormats = &attachments.colorFormat,
+        .depthAttachmentFormat = attachments.depthFormat
     };
 
     /* create pipeline */
@@ -298,32 +862,74 @@ uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule ve
         .pNext = &pipelineRenderingInfo
     };
 
-    VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, allocator, &pipeline->handle);
+    // linked from shared parts, avoids compiling the whole pipeline for new combinations
+    if (useLibraries)
+    {
+        pipelineRenderingInfo.pNext = NULL;
+        if (!ignisLinkPipeline(&pipelineInfo, pipeline))
+        {
+            ignisDiscardPipeline(pipeline);
+            return IGNIS_FAIL;
+        }
+        return IGNIS_OK;
+    }
+
+    VkResult result = vkCreateGraphicsPipelines(device, ignisGetPipelineCache(), 1, &pipelineInfo, allocator, &pipeline->handle);
+    if (result != VK_SUCCESS)
+    {
+        ignisDiscardPipeline(pipeline);
+        return IGNIS_FAIL;
+    }
+
+    ignisRecordPipelineFeedback(&feedback);
+
+    pipeline->handle = ignisSharePipeline(&key, pipeline->handle);
 
-    return result != VK_SUCCESS ? IGNIS_FAIL : IGNIS_OK;
+    return IGNIS_OK;
 }
 
-void ignisDestroyPipeline(IgnisPipeline* pipeline)
+static void ignisDeletePipeline(void* object)
 {
+    IgnisPipeline* pipeline = object;
+
     VkDevice device = ignisGetVkDevice();
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
-    for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
-        ignisDestroyBuffer(&pipeline->uniformBuffers[i]);
+    if (pipeline->libraries[0])
+    {
+        vkDestroyPipeline(device, pipeline->handle, allocator);
+
+        if (!pipeline->link || !ignisDestroyPipelineLink(pipeline->link))
+            ignisReleasePipelineLibraries(pipeline->libraries);
+    }
+    else
+    {
+        ignisReleasePipeline(pipeline->handle);
+    }
+    ignisReleasePipelineLayout(pipeline->layout);
 
-    vkDestroyPipeline(device, pipeline->handle, allocator);
-    vkDestroyPipelineLayout(device, pipeline->layout, allocator);
+    ignisFreePipelineSets(pipeline);
+    ignisReleaseSetLayout(pipeline->descriptorSetLayout);
+}
 
-    vkDestroyDescriptorPool(device, pipeline->descriptorPool, allocator);
-    vkDestroyDescriptorSetLayout(device, pipeline->descriptorSetLayout, allocator);
+void ignisDestroyPipeline(IgnisPipeline* pipeline)
+{
+    // uniforms are copied into frame memory when bound
+    ignisFree(pipeline->uniformData, pipeline->uniformBufferSize);
+    pipeline->uniformData = NULL;
+
+    ignisDeferObject(ignisDeletePipeline, pipeline, sizeof(IgnisPipeline));
 }
 
 void ignisBindPipeline(VkCommandBuffer commandBuffer, IgnisPipeline* pipeline)
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle);
+    VkPipeline handle = pipeline->link ? ignisGetLinkedPipeline(pipeline) : pipeline->handle;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, handle);
 
-    uint32_t frame = ignisGetCurrentFrame();
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, 0, 1, &pipeline->descriptorSets[frame], 0, NULL);
+    VkDescriptorSet bindlessSet = ignisGetBindlessSet();
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, IGNIS_BINDLESS_SET, 1, &bindlessSet, 0, NULL);
+
+    ignisBindUniforms(commandBuffer, pipeline);
 }
 
 uint8_t ignisPushUniform(IgnisPipeline* pipeline, const void* data, uint32_t size, uint32_t offset)
@@ -331,18 +937,42 @@ uint8_t ignisPushUniform(IgnisPipeline* pipeline, const void* data, uint32_t siz
     if (offset + size > pipeline->uniformBufferSize)
         return IGNIS_FAIL;
 
-    uint32_t frame = ignisGetCurrentFrame();
+    memcpy((char*)pipeline->uniformData + offset, data, size);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisBindUniforms(VkCommandBuffer commandBuffer, IgnisPipeline* pipeline)
+{
+    IgnisFrameAllocation allocation;
+    if (!ignisFrameAllocateUniform(pipeline->uniformBufferSize, &allocation))
+        return IGNIS_FAIL;
 
-    memcpy((char*)pipeline->uniformBufferData[frame] + offset, data, size);
+    memcpy(allocation.data, pipeline->uniformData, pipeline->uniformBufferSize);
+
+    uint32_t frame = ignisGetCurrentFrame();
+    uint32_t dynamicOffset = (uint32_t)allocation.offset;
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, 0, 1, &pipeline->descriptorSets[frame], 1, &dynamicOffset);
 
     return IGNIS_OK;
 }
 
+void ignisPushConstants(VkCommandBuffer commandBuffer, const IgnisPipeline* pipeline, VkShaderStageFlags stage, uint32_t offset, uint32_t size, const void* data)
+{
+    vkCmdPushConstants(commandBuffer, pipeline->layout, stage, offset, size, data);
+}
+
 uint8_t ignisBindTexture(IgnisPipeline* pipeline, const IgnisTexture* texture, uint32_t binding)
 {
     VkDevice device = ignisGetVkDevice();
     uint32_t frame = ignisGetCurrentFrame();
 
+    // the set still holds this texture from an earlier frame
+    if (pipeline->boundTextures[frame] == texture->id)
+        return IGNIS_OK;
+
+    pipeline->boundTextures[frame] = texture->id;
+
     VkDescriptorImageInfo imageInfo = {
         .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
         .imageView = texture->view,
@@ -363,3 +993,448 @@ uint8_t ignisBindTexture(IgnisPipeline* pipeline, const IgnisTexture* texture, u
 
     return IGNIS_OK;
 }
+
+/* --------------------------| async |----------------------------------- */
+struct IgnisPipelineBuild
+{
+    IgnisPipelineConfig config; /* arrays are owned by the build */
+    char* vert;
+    char* frag;
+
+    IgnisPipeline* pipeline;
+
+    IgnisMutex* mutex;
+    IgnisCondition* finished;
+
+    uint8_t done;
+    uint8_t result;
+};
+
+static void* ignisCopyArray(const void* src, size_t size)
+{
+    if (!src || !size) return NULL;
+
+    void* dst = ignisAlloc(size);
+    if (dst) memcpy(dst, src, size);
+    return dst;
+}
+
+static void ignisFreePipelineBuild(IgnisPipelineBuild* build)
+{
+    IgnisPipelineConfig* config = &build->config;
+    ignisFree(config->vertexAttributes, sizeof(VkVertexInputAttributeDescription) * config->attributeCount);
+    ignisFree((void*)config->vertexBindings, sizeof(VkVertexInputBindingDescription) * config->vertexBindingCount);
+    ignisFree((void*)config->pushConstantRanges, sizeof(VkPushConstantRange) * config->pushConstantRangeCount);
+
+    if (build->vert) ignisFree(build->vert, strlen(build->vert) + 1);
+    if (build->frag) ignisFree(build->frag, strlen(build->frag) + 1);
+
+    ignisDestroyCondition(build->finished);
+    ignisDestroyMutex(build->mutex);
+
+    ignisFree(build, sizeof(IgnisPipelineBuild));
+}
+
+static void ignisBuildPipeline(void* arg)
+{
+    IgnisPipelineBuild* build = arg;
+
+    VkShaderModule vert = ignisCreateShaderModule(build->vert);
+    VkShaderModule frag = ignisCreateShaderModule(build->frag);
+
+    uint8_t result = ignisCreatePipeline(&build->config, vert, frag, build->pipeline);
+    if (!result) IGNIS_ERROR("failed to build pipeline (%s, %s)", build->vert, build->frag);
+
+    if (vert) ignisDestroyShaderModule(vert);
+    if (frag) ignisDestroyShaderModule(frag);
+
+    ignisLockMutex(build->mutex);
+    build->result = result;
+    build->done = 1;
+    ignisBroadcastCondition(build->finished);
+    ignisUnlockMutex(build->mutex);
+}
+
+IgnisPipelineBuild* ignisCreatePipelineAsync(const IgnisPipelineConfig* config, const char* vert, const char* frag, IgnisPipeline* pipeline)
+{
+    IgnisPipelineBuild* build = ignisAlloc(sizeof(IgnisPipelineBuild));
+    if (!build) return NULL;
+
+    memset(build, 0, sizeof(IgnisPipelineBuild));
+    build->pipeline = pipeline;
+
+    // the caller's arrays might not outlive the build
+    build->config = *config;
+    build->config.vertexAttributes = ignisCopyArray(config->vertexAttributes, sizeof(VkVertexInputAttributeDescription) * config->attributeCount);
+    build->config.vertexBindings = ignisCopyArray(config->vertexBindings, sizeof(VkVertexInputBindingDescription) * config->vertexBindingCount);
+    build->config.pushConstantRanges = ignisCopyArray(config->pushConstantRanges, sizeof(VkPushConstantRange) * config->pushConstantRangeCount);
+
+    build->vert = ignisCopyArray(vert, strlen(vert) + 1);
+    build->frag = ignisCopyArray(frag, strlen(frag) + 1);
+
+    build->mutex = ignisCreateMutex();
+    build->finished = ignisCreateCondition();
+
+    if (!build->vert || !build->frag || !build->mutex || !build->finished)
+    {
+        IGNIS_ERROR("failed to allocate pipeline build!");
+        ignisFreePipelineBuild(build);
+        return NULL;
+    }
+
+    if (!ignisSubmitJob(ignisBuildPipeline, build))
+    {
+        IGNIS_ERROR("failed to submit pipeline build!");
+        ignisFreePipelineBuild(build);
+        return NULL;
+    }
+
+    return build;
+}
+
+uint8_t ignisPipelineReady(IgnisPipelineBuild* build)
+{
+    if (!build) return IGNIS_FAIL;
+
+    ignisLockMutex(build->mutex);
+    uint8_t done = build->done;
+    ignisUnlockMutex(build->mutex);
+
+    return done;
+}
+
+uint8_t ignisWaitPipeline(IgnisPipelineBuild* build)
+{
+    if (!build) return IGNIS_FAIL;
+
+    ignisLockMutex(build->mutex);
+    while (!build->done)
+        ignisWaitCondition(build->finished, build->mutex);
+
+    uint8_t result = build->result;
+    ignisUnlockMutex(build->mutex);
+
+    ignisFreePipelineBuild(build);
+
+    return result;
+}
+
+/* --------------------------| compute |--------------------------------- */
+/* undoes a partially created compute pipeline, the shader module stays with the caller */
+static void ignisDiscardComputePipeline(IgnisComputePipeline* pipeline)
+{
+    ignisReleasePipelineLayout(pipeline->layout);
+    vkDestroyDescriptorPool(ignisGetVkDevice(), pipeline->descriptorPool, ignisGetAllocator());
+    ignisReleaseSetLayout(pipeline->descriptorSetLayout);
+
+    memset(pipeline, 0, sizeof(IgnisComputePipeline));
+}
+
+uint8_t ignisCreateComputePipeline(const IgnisComputePipelineConfig* config, VkShaderModule shader, IgnisComputePipeline* pipeline)
+{
+    if (!shader)
+    {
+        IGNIS_ERROR("Compute shader module is missing");
+        return IGNIS_FAIL;
+    }
+
+    if (config->bindingCount > IGNIS_MAX_COMPUTE_BINDINGS)
+    {
+        IGNIS_ERROR("Too many compute bindings (%d/%d)", config->bindingCount, IGNIS_MAX_COMPUTE_BINDINGS);
+        return IGNIS_FAIL;
+    }
+
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    memset(pipeline, 0, sizeof(IgnisComputePipeline));
+
+    for (uint32_t i = 0; i < 3; ++i)
+        pipeline->groupSize[i] = config->groupSize[i] ? config->groupSize[i] : 1;
+
+    /* descriptor layout */
+    VkDescriptorSetLayoutBinding descriptorBindings[IGNIS_MAX_COMPUTE_BINDINGS];
+    VkDescriptorPoolSize poolSizes[IGNIS_MAX_COMPUTE_BINDINGS];
+    for (uint32_t i = 0; i < config->bindingCount; ++i)
+    {
+        pipeline->bindings[i] = config->bindings[i];
+
+        descriptorBindings[i] = (VkDescriptorSetLayoutBinding){
+            .binding = i,
+            .descriptorType = config->bindings[i],
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL
+        };
+
+        poolSizes[i] = (VkDescriptorPoolSize){
+            .type = config->bindings[i],
+            .descriptorCount = IGNIS_MAX_FRAMES_IN_FLIGHT
+        };
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = config->bindingCount,
+        .pBindings = descriptorBindings
+    };
+
+    if (!ignisAcquireSetLayout(&layoutInfo, &pipeline->descriptorSetLayout))
+        return IGNIS_FAIL;
+
+    /* descriptor sets */
+    if (config->bindingCount)
+    {
+        VkDescriptorPoolCreateInfo poolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .poolSizeCount = config->bindingCount,
+            .pPoolSizes = poolSizes,
+            .maxSets = IGNIS_MAX_FRAMES_IN_FLIGHT
+        };
+
+        if (vkCreateDescriptorPool(device, &poolInfo, allocator, &pipeline->descriptorPool) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to create descriptor pool!");
+            ignisDiscardComputePipeline(pipeline);
+            return IGNIS_FAIL;
+        }
+
+        for (size_t i = 0; i < IGNIS_MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            VkDescriptorSetAllocateInfo allocInfo = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = pipeline->descriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &pipeline->descriptorSetLayout
+            };
+
+            if (vkAllocateDescriptorSets(device, &allocInfo, &pipeline->descriptorSets[i]) != VK_SUCCESS)
+            {
+                IGNIS_ERROR("failed to allocate descriptor sets!");
+                ignisDiscardComputePipeline(pipeline);
+                return IGNIS_FAIL;
+            }
+        }
+    }
+
+    /* layout */
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &pipeline->descriptorSetLayout,
+        .pushConstantRangeCount = config->pushConstantRangeCount,
+        .pPushConstantRanges = config->pushConstantRanges
+    };
+
+    if (!ignisAcquirePipelineLayout(&pipelineLayoutInfo, &pipeline->layout))
+    {
+        ignisDiscardComputePipeline(pipeline);
+        return IGNIS_FAIL;
+    }
+
+    /* reuse an equal pipeline */
+    VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+    uint64_t shaderHash = ignisGetShaderModuleHash(shader);
+
+    IgnisPipelineKey key = { .valid = shaderHash != 0 };
+    ignisKeyAppend(&key, &bindPoint, sizeof(VkPipelineBindPoint));
+    ignisKeyAppend(&key, &pipeline->layout, sizeof(VkPipelineLayout));
+    ignisKeyAppend(&key, &shaderHash, sizeof(uint64_t));
+
+    IgnisRegistryHandle shared;
+    if (key.valid && ignisRegistryFind(IGNIS_REGISTRY_PIPELINE, key.data, key.size, &shared))
+    {
+        pipeline->handle = shared.pipeline;
+        return IGNIS_OK;
+    }
+
+    /* create pipeline */
+    VkPipelineCreationFeedback feedback = { 0 };
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+        .pPipelineCreationFeedback = &feedback
+    };
+
+    VkComputePipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = &feedbackInfo,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shader,
+            .pName = "main",
+        },
+        .layout = pipeline->layout
+    };
+
+    VkResult result = vkCreateComputePipelines(device, ignisGetPipelineCache(), 1, &pipelineInfo, allocator, &pipeline->handle);
+    if (result != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create compute pipeline!");
+        ignisDiscardComputePipeline(pipeline);
+        return IGNIS_FAIL;
+    }
+
+    ignisRecordPipelineFeedback(&feedback);
+
+    pipeline->handle = ignisSharePipeline(&key, pipeline->handle);
+
+    return IGNIS_OK;
+}
+
+static void ignisDeleteComputePipeline(void* object)
+{
+    IgnisComputePipeline* pipeline = object;
+
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    ignisReleasePipeline(pipeline->handle);
+    ignisReleasePipelineLayout(pipeline->layout);
+
+    vkDestroyDescriptorPool(device, pipeline->descriptorPool, allocator);
+    ignisReleaseSetLayout(pipeline->descriptorSetLayout);
+}
+
+void ignisDestroyComputePipeline(IgnisComputePipeline* pipeline)
+{
+    ignisDeferObject(ignisDeleteComputePipeline, pipeline, sizeof(IgnisComputePipeline));
+}
+
+uint8_t ignisSetComputeBuffer(IgnisComputePipeline* pipeline, uint32_t frame, uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    if (frame >= IGNIS_MAX_FRAMES_IN_FLIGHT || binding >= IGNIS_MAX_COMPUTE_BINDINGS)
+    {
+        IGNIS_ERROR("invalid compute binding (frame %d, binding %d)", frame, binding);
+        return IGNIS_FAIL;
+    }
+
+    if (!pipeline->descriptorSets[frame])
+        return IGNIS_FAIL;
+
+    VkDescriptorBufferInfo bufferInfo = {
+        .buffer = buffer,
+        .offset = offset,
+        .range = range
+    };
+
+    VkWriteDescriptorSet descriptorWrite = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = pipeline->descriptorSets[frame],
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorType = pipeline->bindings[binding],
+        .descriptorCount = 1,
+        .pBufferInfo = &bufferInfo
+    };
+
+    vkUpdateDescriptorSets(ignisGetVkDevice(), 1, &descriptorWrite, 0, NULL);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisSetComputeImage(IgnisComputePipeline* pipeline, uint32_t frame, uint32_t binding, VkImageView view, VkImageLayout layout)
+{
+    if (frame >= IGNIS_MAX_FRAMES_IN_FLIGHT || binding >= IGNIS_MAX_COMPUTE_BINDINGS)
+    {
+        IGNIS_ERROR("invalid compute binding (frame %d, binding %d)", frame, binding);
+        return IGNIS_FAIL;
+    }
+
+    if (!pipeline->descriptorSets[frame])
+        return IGNIS_FAIL;
+
+    VkDescriptorImageInfo imageInfo = {
+        .imageLayout = layout,
+        .imageView = view,
+        .sampler = VK_NULL_HANDLE,
+    };
+
+    VkWriteDescriptorSet descriptorWrite = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = pipeline->descriptorSets[frame],
+        .dstBinding = binding,
+        .dstArrayElement = 0,
+        .descriptorType = pipeline->bindings[binding],
+        .descriptorCount = 1,
+        .pImageInfo = &imageInfo
+    };
+
+    vkUpdateDescriptorSets(ignisGetVkDevice(), 1, &descriptorWrite, 0, NULL);
+
+    return IGNIS_OK;
+}
+
+void ignisBindComputePipeline(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->handle);
+
+    uint32_t frame = ignisGetCurrentFrame();
+    if (pipeline->descriptorSets[frame])
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->layout, 0, 1, &pipeline->descriptorSets[frame], 0, NULL);
+}
+
+void ignisPushComputeConstants(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline, uint32_t offset, uint32_t size, const void* data)
+{
+    vkCmdPushConstants(commandBuffer, pipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, offset, size, data);
+}
+
+void ignisDispatch(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline, uint32_t width, uint32_t height, uint32_t depth)
+{
+    uint32_t x = (width + pipeline->groupSize[0] - 1) / pipeline->groupSize[0];
+    uint32_t y = (height + pipeline->groupSize[1] - 1) / pipeline->groupSize[1];
+    uint32_t z = (depth + pipeline->groupSize[2] - 1) / pipeline->groupSize[2];
+
+    if (x && y && z) vkCmdDispatch(commandBuffer, x, y, z);
+}
+
+void ignisMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = srcAccess,
+        .dstAccessMask = dstAccess
+    };
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, NULL, 0, NULL);
+}
+
+void ignisBufferBarrier(VkCommandBuffer commandBuffer, VkBuffer buffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkBufferMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = srcAccess,
+        .dstAccessMask = dstAccess,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, NULL, 1, &barrier, 0, NULL);
+}
+
+void ignisImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspect, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = srcAccess,
+        .dstAccessMask = dstAccess,
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = aspect,
+            .baseMipLevel = 0,
+            .levelCount = VK_REMAINING_MIP_LEVELS,
+            .baseArrayLayer = 0,
+            .layerCount = VK_REMAINING_ARRAY_LAYERS
+        }
+    };
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
@@ -6,6 +6,7 @@
 #include "buffer.h"
 #include "texture.h"
 #include "swapchain.h"
+#include "render_target.h"
 
 VkShaderModule ignisCreateShaderModule(const char* path);
 void ignisDestroyShaderModule(VkShaderModule shader);
@@ -14,29 +15,52 @@ typedef struct
 {
     VkVertexInputAttributeDescription* vertexAttributes;
     size_t attributeCount;
-    uint32_t vertexStride;
+    uint32_t vertexStride; /* single per vertex binding, if no bindings are given */
+
+    /* optional, allows per instance streams */
+    const VkVertexInputBindingDescription* vertexBindings;
+    uint32_t vertexBindingCount;
 
     uint32_t uniformBufferSize;
 
-    /* rasterizer */
-    VkCullModeFlags cullMode;
-    VkFrontFace     frontFace;
+    /* small per draw data, see ignisPushConstants */
+    const VkPushConstantRange* pushConstantRanges;
+    uint32_t pushConstantRangeCount;
+
+    /* zeroed renders to the swapchain, see ignisGetRenderTargetFormats */
+    IgnisAttachmentFormats attachments;
 } IgnisPipelineConfig;
 
 
+#define IGNIS_PIPELINE_LIBRARY_COUNT 4
+
+typedef struct IgnisPipelineLink IgnisPipelineLink;
+
+/* handle and layouts are shared between pipelines created from equal state */
 typedef struct
 {
     VkPipeline handle;
     VkPipelineLayout layout;
+
+    /*
+     * With VK_EXT_graphics_pipeline_library handle is fast linked from shared
+     * libraries. The optimized link is built in the background and bound
+     * instead once it is ready, both are kept until the pipeline is destroyed.
+     */
+    VkPipeline libraries[IGNIS_PIPELINE_LIBRARY_COUNT];
+    IgnisPipelineLink* link;
     
     VkDescriptorSetLayout descriptorSetLayout;
     VkDescriptorPool descriptorPool;
 
-    VkDescriptorSet descriptorSets[IGNIS_MAX_FRAMES_IN_FLIGHT];
+    /* one per frame in flight */
+    VkDescriptorSet* descriptorSets;
+    uint32_t* boundTextures; /* texture ids, skips redundant ignisBindTexture writes */
+    uint32_t frameCount;
 
-    IgnisBuffer uniformBuffers[IGNIS_MAX_FRAMES_IN_FLIGHT];
-    void*       uniformBufferData[IGNIS_MAX_FRAMES_IN_FLIGHT];
-    uint32_t    uniformBufferSize;
+    /* uniforms are copied to the frame allocator when bound */
+    void* uniformData;
+    uint32_t uniformBufferSize;
 } IgnisPipeline;
 
 uint8_t ignisCreatePipeline(const IgnisPipelineConfig* config, VkShaderModule vert, VkShaderModule frag, IgnisPipeline* pipeline);
@@ -44,8 +68,85 @@ void ignisDestroyPipeline(IgnisPipeline* pipeline);
 
 void ignisBindPipeline(VkCommandBuffer commandBuffer, IgnisPipeline* pipeline);
 
+/* pushed uniforms are used by draws after the next bind */
 uint8_t ignisPushUniform(IgnisPipeline* pipeline, const void* data, uint32_t size, uint32_t offset);
+uint8_t ignisBindUniforms(VkCommandBuffer commandBuffer, IgnisPipeline* pipeline);
 
+/* range has to be declared in the pipeline config */
+void ignisPushConstants(VkCommandBuffer commandBuffer, const IgnisPipeline* pipeline, VkShaderStageFlags stage, uint32_t offset, uint32_t size, const void* data);
+
+/* writes the current frame's set, so it has to be called before ignisBindPipeline */
 uint8_t ignisBindTexture(IgnisPipeline* pipeline, const IgnisTexture* texture, uint32_t binding);
 
+/*
+ * Asynchronous pipeline creation. The config is copied and the pipeline is
+ * compiled on the worker pool, together with loading its shader modules.
+ * pipeline must stay valid until the build finished. Use a placeholder
+ * pipeline while ignisPipelineReady returns false or block on the build
+ * with ignisWaitPipeline, which also frees the build and returns whether
+ * the pipeline was created.
+ */
+typedef struct IgnisPipelineBuild IgnisPipelineBuild;
+
+IgnisPipelineBuild* ignisCreatePipelineAsync(const IgnisPipelineConfig* config, const char* vert, const char* frag, IgnisPipeline* pipeline);
+
+uint8_t ignisPipelineReady(IgnisPipelineBuild* build);
+uint8_t ignisWaitPipeline(IgnisPipelineBuild* build);
+
+/* --------------------------| compute |--------------------------------- */
+#define IGNIS_MAX_COMPUTE_BINDINGS 8
+
+typedef struct
+{
+    /* descriptor type of binding i, usually storage buffers or storage images */
+    const VkDescriptorType* bindings;
+    uint32_t bindingCount;
+
+    const VkPushConstantRange* pushConstantRanges;
+    uint32_t pushConstantRangeCount;
+
+    uint32_t groupSize[3]; /* local_size of the shader, used by ignisDispatch */
+} IgnisComputePipelineConfig;
+
+typedef struct
+{
+    VkPipeline handle;
+    VkPipelineLayout layout;
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+
+    /* bound per frame by the caller, so there is a set for every possible frame */
+    VkDescriptorSet descriptorSets[IGNIS_MAX_FRAMES_IN_FLIGHT];
+    VkDescriptorType bindings[IGNIS_MAX_COMPUTE_BINDINGS];
+
+    uint32_t groupSize[3];
+} IgnisComputePipeline;
+
+uint8_t ignisCreateComputePipeline(const IgnisComputePipelineConfig* config, VkShaderModule shader, IgnisComputePipeline* pipeline);
+void ignisDestroyComputePipeline(IgnisComputePipeline* pipeline);
+
+/* every frame has its own set, resources written to a frame's set are used once it is bound in that frame */
+uint8_t ignisSetComputeBuffer(IgnisComputePipeline* pipeline, uint32_t frame, uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+uint8_t ignisSetComputeImage(IgnisComputePipeline* pipeline, uint32_t frame, uint32_t binding, VkImageView view, VkImageLayout layout);
+
+/* binds the pipeline with the current frame's set */
+void ignisBindComputePipeline(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline);
+void ignisPushComputeConstants(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline, uint32_t offset, uint32_t size, const void* data);
+
+/* dispatches enough groups to cover width x height x depth invocations */
+void ignisDispatch(VkCommandBuffer commandBuffer, const IgnisComputePipeline* pipeline, uint32_t width, uint32_t height, uint32_t depth);
+
+/*
+ * Barriers between compute and the rest of the frame. Common cases:
+ *   compute -> compute:  COMPUTE_SHADER/SHADER_WRITE -> COMPUTE_SHADER/SHADER_READ
+ *   compute -> indirect: COMPUTE_SHADER/SHADER_WRITE -> DRAW_INDIRECT/INDIRECT_COMMAND_READ
+ *   compute -> vertex:   COMPUTE_SHADER/SHADER_WRITE -> VERTEX_INPUT/VERTEX_ATTRIBUTE_READ
+ *   compute -> sampling: image barrier GENERAL -> SHADER_READ_ONLY_OPTIMAL
+ */
+void ignisMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+void ignisBufferBarrier(VkCommandBuffer commandBuffer, VkBuffer buffer, VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+void ignisImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspect, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
 #endif /* !IGNIS_PIPELINE_H */
\ No newline at end of file
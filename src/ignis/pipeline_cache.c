@@ -0,0 +1,235 @@
+#include "pipeline_cache.h"
+
+#include "thread.h"
+
+#include <stdio.h>
+
+#ifdef WINDOWS
+#include <Windows.h>
+#endif
+
+#define IGNIS_PIPELINE_CACHE_MAGIC      0x43504749 /* "IGPC" */
+#define IGNIS_PIPELINE_CACHE_MAX_PATH   260
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t dataSize;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t  uuid[VK_UUID_SIZE];
+} IgnisPipelineCacheHeader;
+
+static struct IgnisPipelineCache
+{
+    VkPipelineCache handle;
+
+    char path[IGNIS_PIPELINE_CACHE_MAX_PATH];
+    IgnisPipelineCacheHeader header; /* expected header for this device */
+
+    /* pipelines are created on worker threads as well */
+    IgnisMutex* statsMutex;
+    uint32_t hits;
+    uint32_t misses;
+} pipelineCache;
+
+static void* ignisLoadPipelineCacheData(const char* path, size_t* size)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+    {
+        IGNIS_TRACE("No pipeline cache found at %s", path);
+        return NULL;
+    }
+
+    IgnisPipelineCacheHeader header;
+    if (fread(&header, sizeof(IgnisPipelineCacheHeader), 1, file) != 1
+        || header.magic != IGNIS_PIPELINE_CACHE_MAGIC)
+    {
+        IGNIS_WARN("Discarding invalid pipeline cache %s", path);
+        fclose(file);
+        return NULL;
+    }
+
+    // cache written by another device or driver
+    if (header.vendorID != pipelineCache.header.vendorID
+        || header.deviceID != pipelineCache.header.deviceID
+        || header.driverVersion != pipelineCache.header.driverVersion
+        || memcmp(header.uuid, pipelineCache.header.uuid, VK_UUID_SIZE) != 0)
+    {
+        IGNIS_INFO("Pipeline cache %s belongs to another device or driver", path);
+        fclose(file);
+        return NULL;
+    }
+
+    void* data = header.dataSize ? ignisAlloc(header.dataSize) : NULL;
+    if (!data || fread(data, header.dataSize, 1, file) != 1)
+    {
+        IGNIS_WARN("Failed to read pipeline cache %s", path);
+        if (data) ignisFree(data, header.dataSize);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+
+    *size = header.dataSize;
+    return data;
+}
+
+static uint8_t ignisStorePipelineCacheData(const char* path, const void* data, size_t size)
+{
+    char tmpPath[IGNIS_PIPELINE_CACHE_MAX_PATH + 4];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+    FILE* file = fopen(tmpPath, "wb");
+    if (!file)
+    {
+        IGNIS_WARN("Failed to open %s", tmpPath);
+        return IGNIS_FAIL;
+    }
+
+    IgnisPipelineCacheHeader header = pipelineCache.header;
+    header.dataSize = (uint32_t)size;
+
+    uint8_t written = fwrite(&header, sizeof(IgnisPipelineCacheHeader), 1, file) == 1
+                   && fwrite(data, size, 1, file) == 1;
+
+    if (fclose(file) != 0 || !written)
+    {
+        IGNIS_WARN("Failed to write %s", tmpPath);
+        remove(tmpPath);
+        return IGNIS_FAIL;
+    }
+
+    // replace the old cache in one step
+#ifdef WINDOWS
+    uint8_t moved = MoveFileExA(tmpPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    uint8_t moved = rename(tmpPath, path) == 0;
+#endif
+
+    if (!moved)
+    {
+        IGNIS_WARN("Failed to replace pipeline cache %s", path);
+        remove(tmpPath);
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisCreatePipelineCache(const char* path)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(ignisGetVkPhysicalDevice(), &properties);
+
+    memset(&pipelineCache, 0, sizeof(pipelineCache));
+
+    pipelineCache.header.magic = IGNIS_PIPELINE_CACHE_MAGIC;
+    pipelineCache.header.vendorID = properties.vendorID;
+    pipelineCache.header.deviceID = properties.deviceID;
+    pipelineCache.header.driverVersion = properties.driverVersion;
+    memcpy(pipelineCache.header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    pipelineCache.statsMutex = ignisCreateMutex();
+    if (!pipelineCache.statsMutex)
+        return IGNIS_FAIL;
+
+    void* data = NULL;
+    size_t size = 0;
+
+    if (path)
+    {
+        if (strlen(path) >= IGNIS_PIPELINE_CACHE_MAX_PATH)
+        {
+            IGNIS_ERROR("Pipeline cache path is too long");
+            return IGNIS_FAIL;
+        }
+
+        strcpy(pipelineCache.path, path);
+        data = ignisLoadPipelineCacheData(path, &size);
+    }
+
+    VkPipelineCacheCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = size,
+        .pInitialData = data
+    };
+
+    VkResult result = vkCreatePipelineCache(ignisGetVkDevice(), &info, ignisGetAllocator(), &pipelineCache.handle);
+
+    // the driver may still reject the data, start with an empty cache then
+    if (result != VK_SUCCESS && data)
+    {
+        IGNIS_WARN("Pipeline cache data was rejected by the driver");
+        info.initialDataSize = 0;
+        info.pInitialData = NULL;
+        result = vkCreatePipelineCache(ignisGetVkDevice(), &info, ignisGetAllocator(), &pipelineCache.handle);
+    }
+
+    if (data) ignisFree(data, size);
+
+    if (result != VK_SUCCESS)
+    {
+        IGNIS_ERROR("Failed to create pipeline cache");
+        return IGNIS_FAIL;
+    }
+
+    if (size) IGNIS_TRACE("Loaded pipeline cache (%zu bytes)", size);
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyPipelineCache()
+{
+    VkDevice device = ignisGetVkDevice();
+
+    if (pipelineCache.path[0] && pipelineCache.handle)
+    {
+        size_t size = 0;
+        void* data = NULL;
+
+        if (vkGetPipelineCacheData(device, pipelineCache.handle, &size, NULL) == VK_SUCCESS && size)
+            data = ignisAlloc(size);
+
+        if (data && vkGetPipelineCacheData(device, pipelineCache.handle, &size, data) == VK_SUCCESS)
+        {
+            if (ignisStorePipelineCacheData(pipelineCache.path, data, size))
+                IGNIS_TRACE("Stored pipeline cache (%zu bytes)", size);
+        }
+
+        if (data) ignisFree(data, size);
+    }
+
+    ignisPrintPipelineCacheStats();
+
+    vkDestroyPipelineCache(device, pipelineCache.handle, ignisGetAllocator());
+    pipelineCache.handle = VK_NULL_HANDLE;
+
+    ignisDestroyMutex(pipelineCache.statsMutex);
+    pipelineCache.statsMutex = NULL;
+}
+
+VkPipelineCache ignisGetPipelineCache() { return pipelineCache.handle; }
+
+void ignisRecordPipelineFeedback(const VkPipelineCreationFeedback* feedback)
+{
+    if (!(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT))
+        return;
+
+    uint8_t hit = (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0;
+
+    ignisLockMutex(pipelineCache.statsMutex);
+    if (hit) pipelineCache.hits++;
+    else     pipelineCache.misses++;
+    ignisUnlockMutex(pipelineCache.statsMutex);
+
+    IGNIS_TRACE("Pipeline cache %s (%.2f ms)", hit ? "hit" : "miss", feedback->duration / 1000000.0);
+}
+
+void ignisPrintPipelineCacheStats()
+{
+    IGNIS_INFO("Pipeline cache: %u hits, %u misses", pipelineCache.hits, pipelineCache.misses);
+}
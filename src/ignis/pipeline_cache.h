@@ -0,0 +1,27 @@
+#ifndef IGNIS_PIPELINE_CACHE_H
+#define IGNIS_PIPELINE_CACHE_H
+
+#include "ignis_core.h"
+
+/*
+ * Context wide pipeline cache, shared by all pipeline creation. The cache
+ * is loaded from path on creation and written back when it is destroyed.
+ * The file starts with a header identifying the device and driver that
+ * produced it, a file from another device or driver is discarded. Writes
+ * go to a temporary file that replaces the old one, so a crash never
+ * leaves a half written cache behind. Vulkan synchronizes access to the
+ * cache internally, so pipelines may be created from worker threads.
+ *
+ * path may be NULL, the cache is only kept in memory then.
+ */
+uint8_t ignisCreatePipelineCache(const char* path);
+void ignisDestroyPipelineCache();
+
+VkPipelineCache ignisGetPipelineCache();
+
+/* counts hits and misses, feedback has to be chained into the pipeline create info */
+void ignisRecordPipelineFeedback(const VkPipelineCreationFeedback* feedback);
+
+void ignisPrintPipelineCacheStats();
+
+#endif /* !IGNIS_PIPELINE_CACHE_H */
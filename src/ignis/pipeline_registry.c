@@ -0,0 +1,227 @@
+#include "pipeline_registry.h"
+
+#include "thread.h"
+
+typedef struct
+{
+    uint64_t hash;
+    void* key;
+    size_t keySize;
+
+    IgnisRegistryHandle handle;
+    uint32_t refCount;
+} IgnisRegistryEntry;
+
+typedef struct
+{
+    VkShaderModule module;
+    uint64_t hash;
+} IgnisShaderEntry;
+
+static struct IgnisPipelineRegistry
+{
+    IgnisMutex* mutex;
+
+    IgnisRegistryEntry* entries[IGNIS_REGISTRY_TYPE_MAX_ENUM];
+    uint32_t count[IGNIS_REGISTRY_TYPE_MAX_ENUM];
+    uint32_t capacity[IGNIS_REGISTRY_TYPE_MAX_ENUM];
+
+    IgnisShaderEntry* shaders;
+    uint32_t shaderCount;
+    uint32_t shaderCapacity;
+} registry;
+
+static uint8_t ignisRegistryHandleEqual(IgnisRegistryHandle a, IgnisRegistryHandle b)
+{
+    return memcmp(&a, &b, sizeof(IgnisRegistryHandle)) == 0;
+}
+
+/* has to be called with the mutex locked */
+static IgnisRegistryEntry* ignisRegistryLookup(IgnisRegistryType type, const void* key, size_t keySize, uint64_t hash)
+{
+    for (uint32_t i = 0; i < registry.count[type]; ++i)
+    {
+        IgnisRegistryEntry* entry = &registry.entries[type][i];
+        if (entry->hash == hash && entry->keySize == keySize && memcmp(entry->key, key, keySize) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+uint8_t ignisCreatePipelineRegistry()
+{
+    memset(&registry, 0, sizeof(registry));
+
+    registry.mutex = ignisCreateMutex();
+    return registry.mutex != NULL;
+}
+
+void ignisDestroyPipelineRegistry()
+{
+    for (uint32_t type = 0; type < IGNIS_REGISTRY_TYPE_MAX_ENUM; ++type)
+    {
+        if (registry.count[type])
+            IGNIS_WARN("%d pipeline objects of type %d were not released", registry.count[type], type);
+
+        for (uint32_t i = 0; i < registry.count[type]; ++i)
+            ignisFree(registry.entries[type][i].key, registry.entries[type][i].keySize);
+
+        ignisFree(registry.entries[type], sizeof(IgnisRegistryEntry) * registry.capacity[type]);
+    }
+
+    ignisFree(registry.shaders, sizeof(IgnisShaderEntry) * registry.shaderCapacity);
+    ignisDestroyMutex(registry.mutex);
+
+    memset(&registry, 0, sizeof(registry));
+}
+
+uint8_t ignisRegistryFind(IgnisRegistryType type, const void* key, size_t keySize, IgnisRegistryHandle* handle)
+{
+    uint64_t hash = ignisHashBytes(key, keySize, IGNIS_HASH_SEED);
+
+    ignisLockMutex(registry.mutex);
+
+    IgnisRegistryEntry* entry = ignisRegistryLookup(type, key, keySize, hash);
+    if (entry)
+    {
+        entry->refCount++;
+        *handle = entry->handle;
+    }
+
+    ignisUnlockMutex(registry.mutex);
+
+    return entry != NULL;
+}
+
+uint8_t ignisRegistryInsert(IgnisRegistryType type, const void* key, size_t keySize, IgnisRegistryHandle* handle)
+{
+    uint64_t hash = ignisHashBytes(key, keySize, IGNIS_HASH_SEED);
+
+    ignisLockMutex(registry.mutex);
+
+    // created by another thread in the meantime
+    IgnisRegistryEntry* entry = ignisRegistryLookup(type, key, keySize, hash);
+    if (entry)
+    {
+        entry->refCount++;
+        *handle = entry->handle;
+
+        ignisUnlockMutex(registry.mutex);
+        return IGNIS_FAIL;
+    }
+
+    // without memory the object just stays unshared
+    void* keyCopy = ignisAlloc(keySize);
+    if (keyCopy && ignisReserve((void**)&registry.entries[type], &registry.capacity[type], registry.count[type] + 1, sizeof(IgnisRegistryEntry)))
+    {
+        memcpy(keyCopy, key, keySize);
+
+        registry.entries[type][registry.count[type]++] = (IgnisRegistryEntry){
+            .hash = hash,
+            .key = keyCopy,
+            .keySize = keySize,
+            .handle = *handle,
+            .refCount = 1
+        };
+    }
+    else
+    {
+        IGNIS_WARN("failed to register pipeline object");
+        if (keyCopy) ignisFree(keyCopy, keySize);
+    }
+
+    ignisUnlockMutex(registry.mutex);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisRegistryRetain(IgnisRegistryType type, IgnisRegistryHandle handle)
+{
+    ignisLockMutex(registry.mutex);
+
+    uint8_t found = 0;
+    for (uint32_t i = 0; i < registry.count[type] && !found; ++i)
+    {
+        IgnisRegistryEntry* entry = &registry.entries[type][i];
+        if (!ignisRegistryHandleEqual(entry->handle, handle))
+            continue;
+
+        entry->refCount++;
+        found = 1;
+    }
+
+    ignisUnlockMutex(registry.mutex);
+
+    return found;
+}
+
+uint8_t ignisRegistryRelease(IgnisRegistryType type, IgnisRegistryHandle handle)
+{
+    ignisLockMutex(registry.mutex);
+
+    uint8_t destroy = 1; /* unknown objects are not shared */
+    for (uint32_t i = 0; i < registry.count[type]; ++i)
+    {
+        IgnisRegistryEntry* entry = &registry.entries[type][i];
+        if (!ignisRegistryHandleEqual(entry->handle, handle))
+            continue;
+
+        destroy = --entry->refCount == 0;
+        if (destroy)
+        {
+            ignisFree(entry->key, entry->keySize);
+            *entry = registry.entries[type][--registry.count[type]];
+        }
+        break;
+    }
+
+    ignisUnlockMutex(registry.mutex);
+
+    return destroy;
+}
+
+void ignisRegisterShaderModule(VkShaderModule module, uint64_t hash)
+{
+    ignisLockMutex(registry.mutex);
+
+    if (ignisReserve((void**)&registry.shaders, &registry.shaderCapacity, registry.shaderCount + 1, sizeof(IgnisShaderEntry)))
+        registry.shaders[registry.shaderCount++] = (IgnisShaderEntry){ module, hash };
+
+    ignisUnlockMutex(registry.mutex);
+}
+
+void ignisUnregisterShaderModule(VkShaderModule module)
+{
+    ignisLockMutex(registry.mutex);
+
+    for (uint32_t i = 0; i < registry.shaderCount; ++i)
+    {
+        if (registry.shaders[i].module == module)
+        {
+            registry.shaders[i] = registry.shaders[--registry.shaderCount];
+            break;
+        }
+    }
+
+    ignisUnlockMutex(registry.mutex);
+}
+
+uint64_t ignisGetShaderModuleHash(VkShaderModule module)
+{
+    uint64_t hash = 0;
+
+    ignisLockMutex(registry.mutex);
+
+    for (uint32_t i = 0; i < registry.shaderCount; ++i)
+    {
+        if (registry.shaders[i].module == module)
+        {
+            hash = registry.shaders[i].hash;
+            break;
+        }
+    }
+
+    ignisUnlockMutex(registry.mutex);
+
+    return hash;
+}
@@ -0,0 +1,53 @@
+#ifndef IGNIS_PIPELINE_REGISTRY_H
+#define IGNIS_PIPELINE_REGISTRY_H
+
+#include "ignis_core.h"
+
+/*
+ * Deduplicates pipeline state objects. Objects are registered under a key
+ * describing the state they were created from and shared with every later
+ * request for an equal key. Shared objects are reference counted, every
+ * successful find or insert has to be matched by a release and the last
+ * release tells the caller to destroy the object.
+ *
+ * The registry is thread safe, so pipelines built on worker threads are
+ * shared as well. Two threads may create the same object concurrently,
+ * the second insert then returns the registered object instead.
+ */
+typedef enum
+{
+    IGNIS_REGISTRY_SET_LAYOUT,
+    IGNIS_REGISTRY_PIPELINE_LAYOUT,
+    IGNIS_REGISTRY_PIPELINE,
+    IGNIS_REGISTRY_TYPE_MAX_ENUM
+} IgnisRegistryType;
+
+typedef union
+{
+    VkDescriptorSetLayout setLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+} IgnisRegistryHandle;
+
+uint8_t ignisCreatePipelineRegistry();
+void ignisDestroyPipelineRegistry();
+
+/* adds a reference to the object registered for key */
+uint8_t ignisRegistryFind(IgnisRegistryType type, const void* key, size_t keySize, IgnisRegistryHandle* handle);
+
+/* returns IGNIS_FAIL if key was registered meanwhile, handle is the registered object then */
+uint8_t ignisRegistryInsert(IgnisRegistryType type, const void* key, size_t keySize, IgnisRegistryHandle* handle);
+
+/* adds a reference to a registered object, fails for objects that are not shared */
+uint8_t ignisRegistryRetain(IgnisRegistryType type, IgnisRegistryHandle handle);
+
+/* returns true, if the object is no longer used and has to be destroyed */
+uint8_t ignisRegistryRelease(IgnisRegistryType type, IgnisRegistryHandle handle);
+
+/* shader modules are identified by a hash of their code, 0 if unknown */
+void ignisRegisterShaderModule(VkShaderModule module, uint64_t hash);
+void ignisUnregisterShaderModule(VkShaderModule module);
+
+uint64_t ignisGetShaderModuleHash(VkShaderModule module);
+
+#endif /* !IGNIS_PIPELINE_REGISTRY_H */
@@ -0,0 +1,692 @@
+#include "render_graph.h"
+
+#include "texture.h"
+#include "bindless.h"
+#include "deletion_queue.h"
+
+typedef struct
+{
+    VkImageLayout layout;
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+    VkImageUsageFlags imageUsage;
+} IgnisGraphUsageInfo;
+
+static IgnisGraphUsageInfo ignisGetGraphUsageInfo(IgnisGraphUsage usage, uint8_t write)
+{
+    IgnisGraphUsageInfo info = { 0 };
+    switch (usage)
+    {
+    case IGNIS_GRAPH_COLOR_ATTACHMENT:
+        info.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        info.stage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        info.access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT;
+        if (write) info.access |= VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        break;
+    case IGNIS_GRAPH_DEPTH_ATTACHMENT:
+        info.layout = write ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        info.stage = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+        info.access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        if (write) info.access |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        break;
+    case IGNIS_GRAPH_SAMPLED:
+        info.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        info.stage = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        info.access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_SAMPLED_BIT;
+        break;
+    case IGNIS_GRAPH_STORAGE:
+        info.layout = VK_IMAGE_LAYOUT_GENERAL;
+        info.stage = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        info.access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+        if (write) info.access |= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_STORAGE_BIT;
+        break;
+    case IGNIS_GRAPH_TRANSFER_SRC:
+        info.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        info.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        info.access = VK_ACCESS_2_TRANSFER_READ_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        break;
+    case IGNIS_GRAPH_TRANSFER_DST:
+        info.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        info.stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        info.access = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        info.imageUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        break;
+    }
+    return info;
+}
+
+static uint8_t ignisAccessWrites(VkAccessFlags2 access)
+{
+    const VkAccessFlags2 writes = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+                                | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                                | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+                                | VK_ACCESS_2_TRANSFER_WRITE_BIT
+                                | VK_ACCESS_2_MEMORY_WRITE_BIT;
+    return (access & writes) != 0;
+}
+
+/*
+ * --------------------------------------------------------------
+ *                          transients
+ * --------------------------------------------------------------
+ */
+static void ignisDeleteGraphTransients(void* object)
+{
+    IgnisGraphTransients* transients = object;
+
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    for (uint32_t i = 0; i < transients->imageCount; ++i)
+    {
+        IgnisGraphTransient* transient = &transients->images[i];
+
+        ignisBindlessRemoveTexture(transient->index);
+
+        vkDestroyImageView(device, transient->view, allocator);
+        vkDestroyImage(device, transient->image, allocator);
+    }
+
+    for (uint32_t i = 0; i < transients->slotCount; ++i)
+        ignisFreeDeviceMemory(&transients->slots[i].allocation);
+}
+
+static void ignisReleaseGraphTransients(IgnisRenderGraph* graph)
+{
+    if (graph->transients.imageCount > 0)
+        ignisDeferObject(ignisDeleteGraphTransients, &graph->transients, sizeof(IgnisGraphTransients));
+
+    memset(&graph->transients, 0, sizeof(IgnisGraphTransients));
+}
+
+static uint8_t ignisMatchGraphTransients(const IgnisGraphTransients* cached, const IgnisGraphTransient* images, uint32_t count)
+{
+    if (cached->imageCount != count) return 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const IgnisGraphTransient* a = &cached->images[i];
+        const IgnisGraphTransient* b = &images[i];
+
+        if (a->format != b->format || a->usage != b->usage
+            || a->extent.width != b->extent.width || a->extent.height != b->extent.height
+            || a->firstPass != b->firstPass || a->lastPass != b->lastPass)
+            return 0;
+    }
+
+    return 1;
+}
+
+static uint32_t ignisGetGraphSlot(IgnisGraphTransients* transients, const IgnisGraphTransient* transient, VkMemoryRequirements requirements)
+{
+    /* transients are sorted by their first pass, so the first free slot fits */
+    for (uint32_t i = 0; i < transients->slotCount; ++i)
+    {
+        IgnisGraphSlot* slot = &transients->slots[i];
+        if (slot->lastPass >= transient->firstPass) continue;
+        if (!(slot->requirements.memoryTypeBits & requirements.memoryTypeBits)) continue;
+
+        if (requirements.size > slot->requirements.size)
+            slot->requirements.size = requirements.size;
+        if (requirements.alignment > slot->requirements.alignment)
+            slot->requirements.alignment = requirements.alignment;
+        slot->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+        slot->lastPass = transient->lastPass;
+        return i;
+    }
+
+    IgnisGraphSlot* slot = &transients->slots[transients->slotCount];
+    memset(slot, 0, sizeof(IgnisGraphSlot));
+
+    slot->requirements = requirements;
+    slot->lastPass = transient->lastPass;
+    slot->stage = VK_PIPELINE_STAGE_2_NONE;
+    slot->access = VK_ACCESS_2_NONE;
+
+    return transients->slotCount++;
+}
+
+static uint8_t ignisCreateGraphTransients(IgnisRenderGraph* graph, const IgnisGraphTransient* images, uint32_t count)
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    IgnisGraphTransients* transients = &graph->transients;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IgnisGraphTransient* transient = &transients->images[transients->imageCount++];
+        *transient = images[i];
+
+        transient->image = VK_NULL_HANDLE;
+        transient->view = VK_NULL_HANDLE;
+        transient->index = IGNIS_BINDLESS_INVALID_INDEX;
+
+        VkImageCreateInfo imageInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .extent = { transient->extent.width, transient->extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .format = transient->format,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .usage = transient->usage,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+        };
+
+        if (vkCreateImage(device, &imageInfo, allocator, &transient->image) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to create transient image!");
+            return IGNIS_FAIL;
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, transient->image, &requirements);
+
+        transient->slot = ignisGetGraphSlot(transients, transient, requirements);
+    }
+
+    /* images whose passes do not overlap share the memory of a slot */
+    for (uint32_t i = 0; i < transients->slotCount; ++i)
+    {
+        IgnisGraphSlot* slot = &transients->slots[i];
+        if (!ignisAllocateDeviceMemory(slot->requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, IGNIS_ALLOCATION_OPTIMAL, &slot->allocation))
+        {
+            IGNIS_ERROR("failed to allocate transient image memory!");
+            return IGNIS_FAIL;
+        }
+    }
+
+    for (uint32_t i = 0; i < transients->imageCount; ++i)
+    {
+        IgnisGraphTransient* transient = &transients->images[i];
+        const IgnisAllocation* allocation = &transients->slots[transient->slot].allocation;
+
+        if (vkBindImageMemory(device, transient->image, allocation->memory, allocation->offset) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to bind transient image memory!");
+            return IGNIS_FAIL;
+        }
+
+        VkImageViewCreateInfo viewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = transient->image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = transient->format,
+            .subresourceRange.aspectMask = ignisGetFormatImageAspect(transient->format),
+            .subresourceRange.baseMipLevel = 0,
+            .subresourceRange.levelCount = 1,
+            .subresourceRange.baseArrayLayer = 0,
+            .subresourceRange.layerCount = 1
+        };
+
+        if (vkCreateImageView(device, &viewInfo, allocator, &transient->view) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to create transient image view!");
+            return IGNIS_FAIL;
+        }
+
+        if (transient->usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+            transient->index = ignisBindlessAddTexture(transient->view, graph->sampler);
+    }
+
+    return IGNIS_OK;
+}
+
+/*
+ * --------------------------------------------------------------
+ *                          graph
+ * --------------------------------------------------------------
+ */
+uint8_t ignisCreateRenderGraph(IgnisRenderGraph* graph)
+{
+    memset(graph, 0, sizeof(IgnisRenderGraph));
+
+    VkSamplerCreateInfo samplerInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .minFilter = VK_FILTER_LINEAR,
+        .magFilter = VK_FILTER_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .anisotropyEnable = VK_FALSE,
+        .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+        .unnormalizedCoordinates = VK_FALSE,
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_ALWAYS,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .mipLodBias = 0.0f,
+        .minLod = 0.0f,
+        .maxLod = 0.0f,
+    };
+
+    if (vkCreateSampler(ignisGetVkDevice(), &samplerInfo, ignisGetAllocator(), &graph->sampler) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create render graph sampler!");
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyRenderGraph(IgnisRenderGraph* graph)
+{
+    ignisReleaseGraphTransients(graph);
+    ignisDeferDeletion(IGNIS_DELETE_SAMPLER, (IgnisDeletionHandle){ .sampler = graph->sampler });
+
+    memset(graph, 0, sizeof(IgnisRenderGraph));
+}
+
+void ignisResetRenderGraph(IgnisRenderGraph* graph)
+{
+    graph->passCount = 0;
+    graph->imageCount = 0;
+    graph->barrierCount = 0;
+    graph->finalBarrier = 0;
+}
+
+static IgnisGraphResource ignisGraphAddImage(IgnisRenderGraph* graph, const IgnisGraphImage* image)
+{
+    if (graph->imageCount >= IGNIS_GRAPH_MAX_RESOURCES)
+    {
+        IGNIS_ERROR("render graph has too many images");
+        return IGNIS_GRAPH_INVALID_INDEX;
+    }
+
+    graph->images[graph->imageCount] = *image;
+    return graph->imageCount++;
+}
+
+IgnisGraphResource ignisGraphImportImage(IgnisRenderGraph* graph, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout)
+{
+    // nothing to wait for, if the contents are discarded
+    uint8_t discard = initialLayout == VK_IMAGE_LAYOUT_UNDEFINED;
+
+    IgnisGraphImage graphImage = {
+        .format = format,
+        .extent = extent,
+        .image = image,
+        .view = view,
+        .imported = 1,
+        .finalLayout = finalLayout,
+        .transient = IGNIS_GRAPH_INVALID_INDEX,
+        .layout = initialLayout,
+        .stage = discard ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        .access = discard ? VK_ACCESS_2_NONE : VK_ACCESS_2_MEMORY_WRITE_BIT
+    };
+
+    return ignisGraphAddImage(graph, &graphImage);
+}
+
+IgnisGraphResource ignisGraphCreateImage(IgnisRenderGraph* graph, VkFormat format, VkExtent2D extent)
+{
+    IgnisGraphImage graphImage = {
+        .format = format,
+        .extent = extent,
+        .imported = 0,
+        .transient = IGNIS_GRAPH_INVALID_INDEX,
+        .layout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+
+    return ignisGraphAddImage(graph, &graphImage);
+}
+
+uint32_t ignisGraphAddPass(IgnisRenderGraph* graph, const char* name, IgnisGraphPassFunc func, void* arg)
+{
+    if (graph->passCount >= IGNIS_GRAPH_MAX_PASSES)
+    {
+        IGNIS_ERROR("render graph has too many passes");
+        return IGNIS_GRAPH_INVALID_INDEX;
+    }
+
+    IgnisGraphPass* pass = &graph->passes[graph->passCount];
+    memset(pass, 0, sizeof(IgnisGraphPass));
+
+    pass->name = name;
+    pass->func = func;
+    pass->arg = arg;
+
+    return graph->passCount++;
+}
+
+static uint8_t ignisGraphAccess(IgnisRenderGraph* graph, uint32_t passIndex, IgnisGraphResource resource, IgnisGraphUsage usage, uint8_t write)
+{
+    if (passIndex >= graph->passCount || resource >= graph->imageCount)
+    {
+        IGNIS_ERROR("invalid render graph pass or image");
+        return IGNIS_FAIL;
+    }
+
+    IgnisGraphPass* pass = &graph->passes[passIndex];
+    if (pass->accessCount >= IGNIS_GRAPH_MAX_PASS_ACCESSES)
+    {
+        IGNIS_ERROR("render graph pass %s has too many accesses", pass->name);
+        return IGNIS_FAIL;
+    }
+
+    // an image has one layout per pass, only reads and writes of the same usage merge
+    for (uint32_t i = 0; i < pass->accessCount; ++i)
+    {
+        if (pass->accesses[i].resource == resource && pass->accesses[i].usage != usage)
+        {
+            IGNIS_ERROR("render graph pass %s uses an image with two different usages", pass->name);
+            return IGNIS_FAIL;
+        }
+    }
+
+    pass->accesses[pass->accessCount++] = (IgnisGraphAccess){
+        .resource = resource,
+        .usage = usage,
+        .write = write
+    };
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisGraphRead(IgnisRenderGraph* graph, uint32_t pass, IgnisGraphResource resource, IgnisGraphUsage usage)
+{
+    return ignisGraphAccess(graph, pass, resource, usage, 0);
+}
+
+uint8_t ignisGraphWrite(IgnisRenderGraph* graph, uint32_t pass, IgnisGraphResource resource, IgnisGraphUsage usage)
+{
+    return ignisGraphAccess(graph, pass, resource, usage, 1);
+}
+
+/*
+ * --------------------------------------------------------------
+ *                          compile
+ * --------------------------------------------------------------
+ */
+static void ignisCullGraphPasses(IgnisRenderGraph* graph)
+{
+    uint8_t needed[IGNIS_GRAPH_MAX_RESOURCES] = { 0 };
+    for (uint32_t i = 0; i < graph->imageCount; ++i)
+        needed[i] = graph->images[i].imported;
+
+    /* walk backwards, a pass is needed if it writes something needed later */
+    for (uint32_t p = graph->passCount; p-- > 0;)
+    {
+        IgnisGraphPass* pass = &graph->passes[p];
+
+        uint8_t writes = 0;
+        uint8_t contributes = 0;
+        for (uint32_t a = 0; a < pass->accessCount; ++a)
+        {
+            if (!pass->accesses[a].write) continue;
+
+            writes = 1;
+            if (needed[pass->accesses[a].resource]) contributes = 1;
+        }
+
+        pass->culled = writes && !contributes;
+        if (pass->culled) continue;
+
+        for (uint32_t a = 0; a < pass->accessCount; ++a)
+            needed[pass->accesses[a].resource] = 1;
+    }
+}
+
+static uint8_t ignisPrepareGraphTransients(IgnisRenderGraph* graph)
+{
+    IgnisGraphTransient images[IGNIS_GRAPH_MAX_RESOURCES];
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < graph->imageCount; ++i)
+        graph->images[i].transient = IGNIS_GRAPH_INVALID_INDEX;
+
+    /* in order of first use, images of culled passes are never created */
+    for (uint32_t p = 0; p < graph->passCount; ++p)
+    {
+        const IgnisGraphPass* pass = &graph->passes[p];
+        if (pass->culled) continue;
+
+        for (uint32_t a = 0; a < pass->accessCount; ++a)
+        {
+            const IgnisGraphAccess* access = &pass->accesses[a];
+            IgnisGraphImage* image = &graph->images[access->resource];
+            if (image->imported) continue;
+
+            if (image->transient == IGNIS_GRAPH_INVALID_INDEX)
+            {
+                image->transient = count++;
+                memset(&images[image->transient], 0, sizeof(IgnisGraphTransient));
+
+                images[image->transient].format = image->format;
+                images[image->transient].extent = image->extent;
+                images[image->transient].firstPass = p;
+            }
+
+            IgnisGraphTransient* transient = &images[image->transient];
+            transient->usage |= ignisGetGraphUsageInfo(access->usage, access->write).imageUsage;
+            transient->lastPass = p;
+        }
+    }
+
+    if (ignisMatchGraphTransients(&graph->transients, images, count))
+        return IGNIS_OK;
+
+    ignisReleaseGraphTransients(graph);
+    if (!ignisCreateGraphTransients(graph, images, count))
+    {
+        ignisReleaseGraphTransients(graph);
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+static VkImageMemoryBarrier2* ignisFindGraphBarrier(IgnisRenderGraph* graph, uint32_t first, VkImage image)
+{
+    for (uint32_t i = first; i < graph->barrierCount; ++i)
+    {
+        if (graph->barriers[i].image == image) return &graph->barriers[i];
+    }
+    return NULL;
+}
+
+static void ignisAddGraphBarrier(IgnisRenderGraph* graph, IgnisGraphImage* image, VkImageLayout layout, VkPipelineStageFlags2 stage, VkAccessFlags2 access)
+{
+    graph->barriers[graph->barrierCount++] = (VkImageMemoryBarrier2){
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = image->stage,
+        .srcAccessMask = image->access,
+        .dstStageMask = stage,
+        .dstAccessMask = access,
+        .oldLayout = image->layout,
+        .newLayout = layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image->image,
+        .subresourceRange.aspectMask = ignisGetFormatImageAspect(image->format),
+        .subresourceRange.baseMipLevel = 0,
+        .subresourceRange.levelCount = 1,
+        .subresourceRange.baseArrayLayer = 0,
+        .subresourceRange.layerCount = 1
+    };
+
+    image->layout = layout;
+    image->stage = stage;
+    image->access = access;
+}
+
+static void ignisBuildGraphBarriers(IgnisRenderGraph* graph)
+{
+    uint8_t started[IGNIS_GRAPH_MAX_RESOURCES] = { 0 };
+
+    graph->barrierCount = 0;
+
+    for (uint32_t i = 0; i < graph->imageCount; ++i)
+    {
+        IgnisGraphImage* image = &graph->images[i];
+        if (image->imported || image->transient == IGNIS_GRAPH_INVALID_INDEX) continue;
+
+        image->image = graph->transients.images[image->transient].image;
+        image->view = graph->transients.images[image->transient].view;
+    }
+
+    for (uint32_t p = 0; p < graph->passCount; ++p)
+    {
+        IgnisGraphPass* pass = &graph->passes[p];
+        pass->firstBarrier = graph->barrierCount;
+        pass->barrierCount = 0;
+
+        if (pass->culled) continue;
+
+        for (uint32_t a = 0; a < pass->accessCount; ++a)
+        {
+            const IgnisGraphAccess* access = &pass->accesses[a];
+            IgnisGraphImage* image = &graph->images[access->resource];
+            IgnisGraphUsageInfo info = ignisGetGraphUsageInfo(access->usage, access->write);
+
+            IgnisGraphSlot* slot = NULL;
+            uint8_t sampled = 0;
+            if (!image->imported)
+            {
+                const IgnisGraphTransient* transient = &graph->transients.images[image->transient];
+                slot = &graph->transients.slots[transient->slot];
+                sampled = (transient->usage & VK_IMAGE_USAGE_SAMPLED_BIT) != 0;
+
+                // the first use waits for the previous image in the same memory
+                if (!started[access->resource])
+                {
+                    image->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    image->stage = slot->stage;
+                    image->access = slot->access;
+                    started[access->resource] = 1;
+                }
+            }
+
+            /* a pass using an image twice gets one barrier with both usages */
+            VkImageMemoryBarrier2* barrier = ignisFindGraphBarrier(graph, pass->firstBarrier, image->image);
+            if (barrier)
+            {
+                if (access->write) barrier->newLayout = info.layout;
+                barrier->dstStageMask |= info.stage;
+                barrier->dstAccessMask |= info.access;
+
+                image->layout = barrier->newLayout;
+                image->stage = barrier->dstStageMask;
+                image->access = barrier->dstAccessMask;
+            }
+            else if (image->layout == info.layout && !access->write && !ignisAccessWrites(image->access))
+            {
+                // reads in the same layout do not depend on each other
+                image->stage |= info.stage;
+                image->access |= info.access;
+            }
+            else
+            {
+                ignisAddGraphBarrier(graph, image, info.layout, info.stage, info.access);
+            }
+
+            if (slot)
+            {
+                slot->stage = image->stage;
+                slot->access = image->access;
+
+                // the bindless index lets shaders sample the image outside its
+                // declared accesses, so the next image waits for all shader reads
+                if (sampled)
+                {
+                    slot->stage |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+                    slot->access |= VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+                }
+            }
+        }
+
+        pass->barrierCount = graph->barrierCount - pass->firstBarrier;
+    }
+
+    /* hand imported images back in their final layout */
+    graph->finalBarrier = graph->barrierCount;
+    for (uint32_t i = 0; i < graph->imageCount; ++i)
+    {
+        IgnisGraphImage* image = &graph->images[i];
+        if (!image->imported || image->finalLayout == VK_IMAGE_LAYOUT_UNDEFINED) continue;
+
+        if (image->layout == image->finalLayout && !ignisAccessWrites(image->access)) continue;
+
+        // presentation is ordered by the semaphore of the submit
+        if (image->finalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR)
+            ignisAddGraphBarrier(graph, image, image->finalLayout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
+        else
+            ignisAddGraphBarrier(graph, image, image->finalLayout, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT);
+    }
+}
+
+uint8_t ignisCompileRenderGraph(IgnisRenderGraph* graph)
+{
+    ignisCullGraphPasses(graph);
+
+    if (!ignisPrepareGraphTransients(graph))
+    {
+        IGNIS_ERROR("failed to create transient images");
+        return IGNIS_FAIL;
+    }
+
+    ignisBuildGraphBarriers(graph);
+
+    return IGNIS_OK;
+}
+
+/*
+ * --------------------------------------------------------------
+ *                          execute
+ * --------------------------------------------------------------
+ */
+static void ignisRecordGraphBarriers(VkCommandBuffer commandBuffer, const VkImageMemoryBarrier2* barriers, uint32_t count)
+{
+    if (count == 0) return;
+
+    VkDependencyInfo dependencyInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = count,
+        .pImageMemoryBarriers = barriers
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void ignisExecuteRenderGraph(IgnisRenderGraph* graph, VkCommandBuffer commandBuffer)
+{
+    for (uint32_t p = 0; p < graph->passCount; ++p)
+    {
+        const IgnisGraphPass* pass = &graph->passes[p];
+        if (pass->culled) continue;
+
+        ignisRecordGraphBarriers(commandBuffer, graph->barriers + pass->firstBarrier, pass->barrierCount);
+
+        if (pass->func) pass->func(commandBuffer, pass->arg);
+    }
+
+    ignisRecordGraphBarriers(commandBuffer, graph->barriers + graph->finalBarrier, graph->barrierCount - graph->finalBarrier);
+}
+
+VkImage ignisGetGraphImage(const IgnisRenderGraph* graph, IgnisGraphResource resource)
+{
+    return resource < graph->imageCount ? graph->images[resource].image : VK_NULL_HANDLE;
+}
+
+VkImageView ignisGetGraphImageView(const IgnisRenderGraph* graph, IgnisGraphResource resource)
+{
+    return resource < graph->imageCount ? graph->images[resource].view : VK_NULL_HANDLE;
+}
+
+uint32_t ignisGetGraphTextureIndex(const IgnisRenderGraph* graph, IgnisGraphResource resource)
+{
+    if (resource >= graph->imageCount) return IGNIS_GRAPH_INVALID_INDEX;
+
+    const IgnisGraphImage* image = &graph->images[resource];
+    if (image->imported || image->transient == IGNIS_GRAPH_INVALID_INDEX)
+        return IGNIS_GRAPH_INVALID_INDEX;
+
+    return graph->transients.images[image->transient].index;
+}
@@ -0,0 +1,164 @@
+#ifndef IGNIS_RENDER_GRAPH_H
+#define IGNIS_RENDER_GRAPH_H
+
+#include "ignis_core.h"
+
+/*
+ * Frame render graph. Passes are added every frame together with the images
+ * they read and write, then the graph is compiled and recorded:
+ *
+ *   - passes that contribute nothing to an imported image are culled,
+ *     passes without declared writes are always kept
+ *   - barriers are placed between passes and batched into one
+ *     vkCmdPipelineBarrier2 per pass
+ *   - transient images that are not alive at the same time share memory
+ *
+ * Imported images are owned by the caller and transitioned to their final
+ * layout after the last pass. Transient images only exist inside the graph,
+ * they are kept across frames as long as the passes using them stay the same.
+ *
+ * The graph is recorded outside of rendering (see ignisGetCommandBuffer),
+ * passes begin and end their own rendering with the layouts of their usage.
+ */
+#define IGNIS_GRAPH_MAX_PASSES          32
+#define IGNIS_GRAPH_MAX_RESOURCES       32
+#define IGNIS_GRAPH_MAX_PASS_ACCESSES   8
+#define IGNIS_GRAPH_MAX_BARRIERS        (IGNIS_GRAPH_MAX_PASSES * IGNIS_GRAPH_MAX_PASS_ACCESSES + IGNIS_GRAPH_MAX_RESOURCES)
+
+#define IGNIS_GRAPH_INVALID_INDEX       UINT32_MAX
+
+typedef uint32_t IgnisGraphResource;
+
+typedef enum
+{
+    IGNIS_GRAPH_COLOR_ATTACHMENT, /* COLOR_ATTACHMENT_OPTIMAL */
+    IGNIS_GRAPH_DEPTH_ATTACHMENT, /* DEPTH_STENCIL_ATTACHMENT_OPTIMAL, READ_ONLY_OPTIMAL if only read */
+    IGNIS_GRAPH_SAMPLED,          /* SHADER_READ_ONLY_OPTIMAL, in fragment and compute shaders */
+    IGNIS_GRAPH_STORAGE,          /* GENERAL, in compute shaders */
+    IGNIS_GRAPH_TRANSFER_SRC,     /* TRANSFER_SRC_OPTIMAL */
+    IGNIS_GRAPH_TRANSFER_DST      /* TRANSFER_DST_OPTIMAL */
+} IgnisGraphUsage;
+
+typedef void (*IgnisGraphPassFunc)(VkCommandBuffer commandBuffer, void* arg);
+
+typedef struct
+{
+    IgnisGraphResource resource;
+    IgnisGraphUsage usage;
+    uint8_t write;
+} IgnisGraphAccess;
+
+typedef struct
+{
+    const char* name;
+    IgnisGraphPassFunc func;
+    void* arg;
+
+    IgnisGraphAccess accesses[IGNIS_GRAPH_MAX_PASS_ACCESSES];
+    uint32_t accessCount;
+
+    /* set by ignisCompileRenderGraph */
+    uint8_t culled;
+    uint32_t firstBarrier;
+    uint32_t barrierCount;
+} IgnisGraphPass;
+
+typedef struct
+{
+    VkFormat format;
+    VkExtent2D extent;
+
+    VkImage image;
+    VkImageView view;
+
+    uint8_t imported;
+    VkImageLayout finalLayout; /* only for imported images */
+
+    uint32_t transient; /* index into the graph's transient images */
+
+    /* state after the last compiled access */
+    VkImageLayout layout;
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+} IgnisGraphImage;
+
+typedef struct
+{
+    VkFormat format;
+    VkExtent2D extent;
+    VkImageUsageFlags usage;
+
+    /* passes the image is alive for */
+    uint32_t firstPass;
+    uint32_t lastPass;
+
+    uint32_t slot;
+
+    VkImage image;
+    VkImageView view;
+    uint32_t index; /* bindless slot, if sampled */
+} IgnisGraphTransient;
+
+/* memory shared by transient images */
+typedef struct
+{
+    IgnisAllocation allocation;
+    VkMemoryRequirements requirements;
+    uint32_t lastPass;
+
+    /* last access of the previous image, the next one has to wait for it */
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+} IgnisGraphSlot;
+
+/* kept as long as the passes using them stay the same */
+typedef struct
+{
+    IgnisGraphTransient images[IGNIS_GRAPH_MAX_RESOURCES];
+    uint32_t imageCount;
+
+    IgnisGraphSlot slots[IGNIS_GRAPH_MAX_RESOURCES];
+    uint32_t slotCount;
+} IgnisGraphTransients;
+
+typedef struct
+{
+    IgnisGraphPass passes[IGNIS_GRAPH_MAX_PASSES];
+    uint32_t passCount;
+
+    IgnisGraphImage images[IGNIS_GRAPH_MAX_RESOURCES];
+    uint32_t imageCount;
+
+    VkImageMemoryBarrier2 barriers[IGNIS_GRAPH_MAX_BARRIERS];
+    uint32_t barrierCount;
+    uint32_t finalBarrier; /* transitions of imported images after the last pass */
+
+    IgnisGraphTransients transients;
+    VkSampler sampler; /* for sampled transient images */
+} IgnisRenderGraph;
+
+/* the graph is large, it should not live on the stack */
+uint8_t ignisCreateRenderGraph(IgnisRenderGraph* graph);
+void ignisDestroyRenderGraph(IgnisRenderGraph* graph);
+
+/* removes all passes and images, transient images are kept for reuse */
+void ignisResetRenderGraph(IgnisRenderGraph* graph);
+
+IgnisGraphResource ignisGraphImportImage(IgnisRenderGraph* graph, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent, VkImageLayout initialLayout, VkImageLayout finalLayout);
+IgnisGraphResource ignisGraphCreateImage(IgnisRenderGraph* graph, VkFormat format, VkExtent2D extent);
+
+uint32_t ignisGraphAddPass(IgnisRenderGraph* graph, const char* name, IgnisGraphPassFunc func, void* arg);
+
+/* a pass may read and write an image, but only with a single usage */
+uint8_t ignisGraphRead(IgnisRenderGraph* graph, uint32_t pass, IgnisGraphResource resource, IgnisGraphUsage usage);
+uint8_t ignisGraphWrite(IgnisRenderGraph* graph, uint32_t pass, IgnisGraphResource resource, IgnisGraphUsage usage);
+
+uint8_t ignisCompileRenderGraph(IgnisRenderGraph* graph);
+void ignisExecuteRenderGraph(IgnisRenderGraph* graph, VkCommandBuffer commandBuffer);
+
+/* valid after compiling */
+VkImage     ignisGetGraphImage(const IgnisRenderGraph* graph, IgnisGraphResource resource);
+VkImageView ignisGetGraphImageView(const IgnisRenderGraph* graph, IgnisGraphResource resource);
+uint32_t    ignisGetGraphTextureIndex(const IgnisRenderGraph* graph, IgnisGraphResource resource);
+
+#endif /* !IGNIS_RENDER_GRAPH_H */
@@ -0,0 +1,216 @@
+#include "render_target.h"
+
+static uint8_t ignisCreateRenderTargetAttachments(IgnisRenderTarget* target)
+{
+    const IgnisAttachmentFormats* formats = &target->config.formats;
+    const IgnisAttachmentOps* ops = &target->config.ops;
+
+    uint32_t width = target->extent.width;
+    uint32_t height = target->extent.height;
+
+    uint8_t multisampled = formats->samples != VK_SAMPLE_COUNT_1_BIT;
+
+    IgnisTextureConfig textureConfig = {
+        .minFilter = target->config.filter,
+        .magFilter = target->config.filter,
+        .addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+    };
+
+    memset(&target->color, 0, sizeof(IgnisTexture));
+    memset(&target->depth, 0, sizeof(IgnisTexture));
+    memset(&target->multisampled, 0, sizeof(IgnisTexture));
+
+    target->colorLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    target->depthLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    target->multisampledLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (formats->colorFormat != VK_FORMAT_UNDEFINED)
+    {
+        textureConfig.format = formats->colorFormat;
+
+        /* single sampled color, either rendered to or resolved into */
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (!ignisCreateAttachmentTexture(width, height, usage, VK_SAMPLE_COUNT_1_BIT, &textureConfig, &target->color))
+            return IGNIS_FAIL;
+
+        /* samples only live until they are resolved */
+        usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        if (multisampled && !ignisCreateAttachmentTexture(width, height, usage, formats->samples, &textureConfig, &target->multisampled))
+            return IGNIS_FAIL;
+    }
+
+    if (formats->depthFormat != VK_FORMAT_UNDEFINED)
+    {
+        textureConfig.format = formats->depthFormat;
+
+        // stored depth is kept for sampling (e.g. shadow maps), unless it has samples
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (ops->depthStoreOp != VK_ATTACHMENT_STORE_OP_STORE)
+            usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        else if (!multisampled)
+            usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        if (!ignisCreateAttachmentTexture(width, height, usage, formats->samples, &textureConfig, &target->depth))
+            return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+static void ignisDestroyRenderTargetAttachments(IgnisRenderTarget* target)
+{
+    if (target->color.image)        ignisDestroyTexture(&target->color);
+    if (target->depth.image)        ignisDestroyTexture(&target->depth);
+    if (target->multisampled.image) ignisDestroyTexture(&target->multisampled);
+}
+
+uint8_t ignisCreateRenderTarget(uint32_t width, uint32_t height, const IgnisRenderTargetConfig* configPtr, IgnisRenderTarget* target)
+{
+    target->config = configPtr ? *configPtr : IGNIS_DEFAULT_RENDER_TARGET_CONFIG;
+    target->extent = (VkExtent2D){ width, height };
+
+    if (target->config.formats.colorFormat == VK_FORMAT_UNDEFINED && target->config.formats.depthFormat == VK_FORMAT_UNDEFINED)
+    {
+        IGNIS_ERROR("render target needs at least one attachment");
+        return IGNIS_FAIL;
+    }
+
+    target->clearColor = (VkClearValue){ .color = { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    target->clearDepth = (VkClearValue){ .depthStencil = { 1.0f, 0 } };
+
+    if (!ignisCreateRenderTargetAttachments(target))
+    {
+        IGNIS_ERROR("failed to create render target attachments");
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyRenderTarget(IgnisRenderTarget* target)
+{
+    ignisDestroyRenderTargetAttachments(target);
+}
+
+uint8_t ignisResizeRenderTarget(IgnisRenderTarget* target, uint32_t width, uint32_t height)
+{
+    if (target->extent.width == width && target->extent.height == height)
+        return IGNIS_OK;
+
+    ignisDestroyRenderTargetAttachments(target);
+    target->extent = (VkExtent2D){ width, height };
+
+    return ignisCreateRenderTargetAttachments(target);
+}
+
+IgnisAttachmentFormats ignisGetRenderTargetFormats(const IgnisRenderTarget* target)
+{
+    return target->config.formats;
+}
+
+static void ignisTransitionAttachment(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspect, VkImageLayout* layout, VkImageLayout newLayout)
+{
+    // also orders passes of consecutive frames, if the layout stays the same
+    ignisTransitionImageLayout(commandBuffer, image, aspect, *layout, newLayout);
+    *layout = newLayout;
+}
+
+void ignisBeginRenderTarget(VkCommandBuffer commandBuffer, IgnisRenderTarget* target, VkRenderingFlags flags)
+{
+    const IgnisAttachmentOps* ops = &target->config.ops;
+
+    VkRenderingAttachmentInfo colorAttachmentInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+        .imageView = target->color.view,
+        .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .loadOp = ops->colorLoadOp,
+        .storeOp = ops->colorStoreOp,
+        .clearValue = target->clearColor
+    };
+
+    VkRenderingAttachmentInfo depthAttachmentInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+        .imageView = target->depth.view,
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        .loadOp = ops->depthLoadOp,
+        .storeOp = ops->depthStoreOp,
+        .clearValue = target->clearDepth
+    };
+
+    if (target->color.image)
+    {
+        ignisTransitionAttachment(commandBuffer, target->color.image, VK_IMAGE_ASPECT_COLOR_BIT, &target->colorLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    }
+
+    if (target->multisampled.image)
+    {
+        ignisTransitionAttachment(commandBuffer, target->multisampled.image, VK_IMAGE_ASPECT_COLOR_BIT, &target->multisampledLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+        /* render the samples and resolve them into color */
+        colorAttachmentInfo.imageView = target->multisampled.view;
+        colorAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachmentInfo.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachmentInfo.resolveImageView = target->color.view;
+        colorAttachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    if (target->depth.image)
+    {
+        ignisTransitionAttachment(commandBuffer, target->depth.image, VK_IMAGE_ASPECT_DEPTH_BIT, &target->depthLayout, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+    }
+
+    VkRenderingInfo renderInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+        .flags = flags,
+        .renderArea.offset = { 0, 0 },
+        .renderArea.extent = target->extent,
+        .layerCount = 1,
+        .colorAttachmentCount = target->color.image ? 1 : 0,
+        .pColorAttachments = &colorAttachmentInfo,
+        .pDepthAttachment = target->depth.image ? &depthAttachmentInfo : NULL
+    };
+
+    vkCmdBeginRendering(commandBuffer, &renderInfo);
+
+    if (!(flags & VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT))
+        ignisRecordRenderTargetState(commandBuffer, target);
+}
+
+void ignisRecordRenderTargetState(VkCommandBuffer commandBuffer, const IgnisRenderTarget* target)
+{
+    ignisRecordDynamicState(commandBuffer);
+
+    // flipped like ignisSetViewport, so targets match the swapchain's orientation and winding
+    VkViewport viewport = {
+        .x = 0.0f,
+        .y = (float)target->extent.height,
+        .width = (float)target->extent.width,
+        .height = -(float)target->extent.height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+
+    VkRect2D scissor = {
+        .offset = { 0, 0 },
+        .extent = target->extent
+    };
+
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void ignisEndRenderTarget(VkCommandBuffer commandBuffer, IgnisRenderTarget* target)
+{
+    vkCmdEndRendering(commandBuffer);
+
+    // sampled attachments are read by the following passes
+    if (target->color.image)
+    {
+        ignisTransitionAttachment(commandBuffer, target->color.image, VK_IMAGE_ASPECT_COLOR_BIT, &target->colorLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    if (target->depth.sampler)
+    {
+        ignisTransitionAttachment(commandBuffer, target->depth.image, VK_IMAGE_ASPECT_DEPTH_BIT, &target->depthLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef IGNIS_RENDER_TARGET_H
+#define IGNIS_RENDER_TARGET_H
+
+#include "ignis_core.h"
+
+#include "texture.h"
+
+/* attachment formats a pipeline renders to */
+typedef struct
+{
+    VkFormat colorFormat; /* VK_FORMAT_UNDEFINED if there is no color attachment */
+    VkFormat depthFormat; /* VK_FORMAT_UNDEFINED if there is no depth attachment */
+    VkSampleCountFlagBits samples;
+} IgnisAttachmentFormats;
+
+typedef struct
+{
+    IgnisAttachmentFormats formats;
+    IgnisAttachmentOps ops;
+
+    VkFilter filter; /* for sampling the results */
+} IgnisRenderTargetConfig;
+
+#define IGNIS_DEFAULT_RENDER_TARGET_CONFIG (IgnisRenderTargetConfig){                         \
+    { VK_FORMAT_R8G8B8A8_UNORM, ignisGetSwapchainDepthFormat(), VK_SAMPLE_COUNT_1_BIT },        \
+    { VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE }, \
+    VK_FILTER_LINEAR }
+
+/*
+ * Offscreen attachments that are rendered to in their own pass and sampled
+ * afterwards through the bindless index of color (or depth, if it is stored
+ * and single sampled). Multisampled color is resolved into color at the end
+ * of the pass. Attachments that are not stored are transient.
+ *
+ * Passes are recorded into ignisGetCommandBuffer before ignisBeginCommandBuffer
+ * begins rendering to the swapchain. Pipelines drawing into the target are
+ * created with its formats, see ignisGetRenderTargetFormats.
+ */
+typedef struct
+{
+    IgnisRenderTargetConfig config;
+    VkExtent2D extent;
+
+    IgnisTexture color;
+    IgnisTexture depth;
+    IgnisTexture multisampled; /* only for multisampled color */
+
+    /* layouts after the last recorded pass */
+    VkImageLayout colorLayout;
+    VkImageLayout depthLayout;
+    VkImageLayout multisampledLayout;
+
+    VkClearValue clearColor;
+    VkClearValue clearDepth;
+} IgnisRenderTarget;
+
+uint8_t ignisCreateRenderTarget(uint32_t width, uint32_t height, const IgnisRenderTargetConfig* configPtr, IgnisRenderTarget* target);
+void ignisDestroyRenderTarget(IgnisRenderTarget* target);
+
+/* the old attachments are deleted once the frames in flight are done with them */
+uint8_t ignisResizeRenderTarget(IgnisRenderTarget* target, uint32_t width, uint32_t height);
+
+IgnisAttachmentFormats ignisGetRenderTargetFormats(const IgnisRenderTarget* target);
+
+/*
+ * Records the layout transitions and sets viewport and scissor to the whole
+ * target. Passes recorded with ignisRecordParallel are begun with
+ * VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, their secondary
+ * buffers set the state themselves.
+ */
+void ignisBeginRenderTarget(VkCommandBuffer commandBuffer, IgnisRenderTarget* target, VkRenderingFlags flags);
+void ignisEndRenderTarget(VkCommandBuffer commandBuffer, IgnisRenderTarget* target);
+
+/* raster state as set for the frame, but with the whole target as viewport */
+void ignisRecordRenderTargetState(VkCommandBuffer commandBuffer, const IgnisRenderTarget* target);
+
+#endif /* !IGNIS_RENDER_TARGET_H */
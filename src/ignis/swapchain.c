@@ -2,8 +2,127 @@
 
 #include "utils.h"
 
+static uint8_t ignisCreateAttachmentImage(VkDevice device, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage, VkMemoryPropertyFlags preferred, const VkAllocationCallbacks* allocator, VkImage* image, IgnisAllocation* allocation)
+{
+    VkImageCreateInfo imageInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .extent.width = extent.width,
+        .extent.height = extent.height,
+        .extent.depth = 1,
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .format = format,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .usage = usage,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .flags = 0
+    };
+
+    if (vkCreateImage(device, &imageInfo, allocator, image) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create image!");
+        return IGNIS_FAIL;
+    }
+
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    if (!ignisAllocateImageMemory(*image, properties, preferred, allocation))
+    {
+        IGNIS_ERROR("failed to allocate image memory!");
+        vkDestroyImage(device, *image, allocator);
+        *image = VK_NULL_HANDLE;
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+static uint8_t ignisCreateSwapchainAttachments(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+{
+    swapchain->imageViews = ignisAlloc(swapchain->imageCount * sizeof(VkImageView));
+    if (!swapchain->imageViews) return IGNIS_FAIL;
+
+    memset(swapchain->imageViews, 0, swapchain->imageCount * sizeof(VkImageView));
+
+    for (size_t i = 0; i < swapchain->imageCount; ++i)
+    {
+        /* create image view */
+        VkImageViewCreateInfo imageViewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = swapchain->images[i],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = swapchain->imageFormat,
+            .components.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .components.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .components.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .components.a = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .subresourceRange.baseMipLevel = 0,
+            .subresourceRange.levelCount = 1,
+            .subresourceRange.baseArrayLayer = 0,
+            .subresourceRange.layerCount = 1
+        };
+
+        if (vkCreateImageView(device, &imageViewInfo, allocator, &swapchain->imageViews[i]) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to create image view");
+            return IGNIS_FAIL;
+        }
+    }
 
-uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkSwapchainKHR old, VkExtent2D extent, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+    return IGNIS_OK;
+}
+
+uint8_t ignisCreateSwapchainDepth(VkDevice device, uint32_t count, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+{
+    swapchain->depthCount = count;
+
+    swapchain->depthImages = ignisAlloc(count * sizeof(VkImage));
+    swapchain->depthImageViews = ignisAlloc(count * sizeof(VkImageView));
+    swapchain->depthImageAllocations = ignisAlloc(count * sizeof(IgnisAllocation));
+    if (!swapchain->depthImages || !swapchain->depthImageViews || !swapchain->depthImageAllocations)
+        return IGNIS_FAIL;
+
+    /* cleared, so a partially created set can be destroyed */
+    memset(swapchain->depthImages, 0, count * sizeof(VkImage));
+    memset(swapchain->depthImageViews, 0, count * sizeof(VkImageView));
+    memset(swapchain->depthImageAllocations, 0, count * sizeof(IgnisAllocation));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        /* depth is never read after the frame, so tiled gpus can keep it in tile memory */
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        VkMemoryPropertyFlags preferred = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        if (!ignisCreateAttachmentImage(device, swapchain->extent, swapchain->depthFormat, usage, preferred, allocator, &swapchain->depthImages[i], &swapchain->depthImageAllocations[i]))
+            return IGNIS_FAIL;
+
+        /* create depth image view */
+        VkImageViewCreateInfo depthImageViewInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = swapchain->depthImages[i],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = swapchain->depthFormat,
+            .subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+            .subresourceRange.baseMipLevel = 0,
+            .subresourceRange.levelCount = 1,
+            .subresourceRange.baseArrayLayer = 0,
+            .subresourceRange.layerCount = 1
+        };
+
+        if (vkCreateImageView(device, &depthImageViewInfo, allocator, &swapchain->depthImageViews[i]) != VK_SUCCESS)
+        {
+            IGNIS_ERROR("failed to create depth image view!");
+            return IGNIS_FAIL;
+        }
+    }
+
+    return IGNIS_OK;
+}
+
+
+uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkSwapchainKHR old, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
 {
     /* choose swap chain surface format */
     VkSurfaceFormatKHR surfaceFormat = ignisChooseSurfaceFormat(physical, surface);
@@ -34,7 +153,12 @@ uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfa
         extent = ignisClampExtent2D(extent, capabilities.minImageExtent, capabilities.maxImageExtent);
 
     /* get image count */
-    uint32_t imageCount = capabilities.minImageCount + 1;
+    if (imageCount == 0)
+        imageCount = capabilities.minImageCount + 1;
+
+    if (imageCount < capabilities.minImageCount)
+        imageCount = capabilities.minImageCount;
+
     if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
         imageCount = capabilities.maxImageCount;
 
@@ -80,6 +204,7 @@ uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfa
     swapchain->imageCount = imageCount;
     swapchain->imageFormat = surfaceFormat.format;
     swapchain->depthFormat = depthFormat;
+    swapchain->imageAllocations = NULL;
 
     /* create images */
     swapchain->images = ignisAlloc(swapchain->imageCount * sizeof(VkImage));
@@ -91,124 +216,74 @@ uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfa
         return IGNIS_FAIL;
     }
 
-    swapchain->imageViews = ignisAlloc(swapchain->imageCount * sizeof(VkImageView));
-    if (!swapchain->imageViews) return IGNIS_FAIL;
-
-    swapchain->depthImages = ignisAlloc(swapchain->imageCount * sizeof(VkImage));
-    if (!swapchain->depthImages) return IGNIS_FAIL;
-
-    swapchain->depthImageViews = ignisAlloc(swapchain->imageCount * sizeof(VkImageView));
-    if (!swapchain->depthImageViews) return IGNIS_FAIL;
-
-    swapchain->depthImageMemories = ignisAlloc(swapchain->imageCount * sizeof(VkDeviceMemory));
-    if (!swapchain->depthImageMemories) return IGNIS_FAIL;
+    return ignisCreateSwapchainAttachments(device, allocator, swapchain);
+}
 
-    for (size_t i = 0; i < swapchain->imageCount; ++i)
+uint8_t ignisCreateHeadlessSwapchain(VkDevice device, VkPhysicalDevice physical, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+{
+    /* query for depth format */
+    VkFormat depthFormat = ignisQueryDepthFormat(physical);
+    if (depthFormat == VK_FORMAT_UNDEFINED)
     {
-        /* create image view */
-        VkImageViewCreateInfo imageViewInfo = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .image = swapchain->images[i],
-            .viewType = VK_IMAGE_VIEW_TYPE_2D,
-            .format = swapchain->imageFormat,
-            .components.r = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .components.g = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .components.b = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .components.a = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .subresourceRange.baseMipLevel = 0,
-            .subresourceRange.levelCount = 1,
-            .subresourceRange.baseArrayLayer = 0,
-            .subresourceRange.layerCount = 1
-        };
-
-        if (vkCreateImageView(device, &imageViewInfo, allocator, &swapchain->imageViews[i]) != VK_SUCCESS)
-        {
-            IGNIS_ERROR("failed to create image view");
-            return IGNIS_FAIL;
-        }
+        IGNIS_ERROR("failed to find suitable depth format!");
+        return IGNIS_FAIL;
+    }
 
-        /* create depth image */
-        VkImageCreateInfo depthImageInfo = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-            .imageType = VK_IMAGE_TYPE_2D,
-            .extent.width = swapchain->extent.width,
-            .extent.height = swapchain->extent.height,
-            .extent.depth = 1,
-            .mipLevels = 1,
-            .arrayLayers = 1,
-            .format = swapchain->depthFormat,
-            .tiling = VK_IMAGE_TILING_OPTIMAL,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-            .flags = 0
-        };
+    swapchain->handle = VK_NULL_HANDLE;
+    swapchain->extent = extent;
+    swapchain->imageCount = imageCount ? imageCount : IGNIS_MAX_FRAMES_IN_FLIGHT;
+    swapchain->imageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+    swapchain->depthFormat = depthFormat;
 
-        if (vkCreateImage(device, &depthImageInfo, allocator, &swapchain->depthImages[i]) != VK_SUCCESS)
-        {
-            IGNIS_ERROR("failed to create image!");
-            return IGNIS_FAIL;
-        }
+    /* create device owned images that stand in for the presentable images */
+    swapchain->images = ignisAlloc(swapchain->imageCount * sizeof(VkImage));
+    if (!swapchain->images) return IGNIS_FAIL;
 
-        VkMemoryRequirements memoryReq;
-        vkGetImageMemoryRequirements(device, swapchain->depthImages[i], &memoryReq);
+    memset(swapchain->images, 0, swapchain->imageCount * sizeof(VkImage));
 
-        VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    swapchain->imageAllocations = ignisAlloc(swapchain->imageCount * sizeof(IgnisAllocation));
+    if (!swapchain->imageAllocations) return IGNIS_FAIL;
 
-        swapchain->depthImageMemories[i] = ignisAllocateDeviceMemory(memoryReq, properties, allocator);
-        if (!swapchain->depthImageMemories[i])
-        {
-            IGNIS_ERROR("failed to allocate image memory!");
-            return IGNIS_FAIL;
-        }
+    memset(swapchain->imageAllocations, 0, swapchain->imageCount * sizeof(IgnisAllocation));
 
-        if (vkBindImageMemory(device, swapchain->depthImages[i], swapchain->depthImageMemories[i], 0) != VK_SUCCESS)
-        {
-            IGNIS_ERROR("failed to bind image memory!");
-            return IGNIS_FAIL;
-        }
-
-        /* create depth image view */
-        VkImageViewCreateInfo depthImageViewInfo = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .image = swapchain->depthImages[i],
-            .viewType = VK_IMAGE_VIEW_TYPE_2D,
-            .format = swapchain->depthFormat,
-            .subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-            .subresourceRange.baseMipLevel = 0,
-            .subresourceRange.levelCount = 1,
-            .subresourceRange.baseArrayLayer = 0,
-            .subresourceRange.layerCount = 1
-        };
-
-        if (vkCreateImageView(device, &depthImageViewInfo, allocator, &swapchain->depthImageViews[i]) != VK_SUCCESS)
-        {
-            IGNIS_ERROR("failed to create depth image view!");
+    for (size_t i = 0; i < swapchain->imageCount; ++i)
+    {
+        /* transfer source allows reading back rendered frames */
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        if (!ignisCreateAttachmentImage(device, swapchain->extent, swapchain->imageFormat, usage, 0, allocator, &swapchain->images[i], &swapchain->imageAllocations[i]))
             return IGNIS_FAIL;
-        }
     }
 
-    return IGNIS_OK;
+    return ignisCreateSwapchainAttachments(device, allocator, swapchain);
 }
 
-void ignisDestroySwapchain(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+void ignisDestroySwapchainDepth(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
 {
-    /* destroy depth images */
-    if (swapchain->depthImages)
+    if (swapchain->depthImages && swapchain->depthImageViews && swapchain->depthImageAllocations)
     {
-        for (size_t i = 0; i < swapchain->imageCount; ++i)
+        for (size_t i = 0; i < swapchain->depthCount; ++i)
         {
             vkDestroyImageView(device, swapchain->depthImageViews[i], allocator);
             vkDestroyImage(device, swapchain->depthImages[i], allocator);
-            vkFreeMemory(device, swapchain->depthImageMemories[i], allocator);
+            ignisFreeDeviceMemory(&swapchain->depthImageAllocations[i]);
         }
-        ignisFree(swapchain->depthImages, swapchain->imageCount * sizeof(VkImage));
-        ignisFree(swapchain->depthImageViews, swapchain->imageCount * sizeof(VkImageView));
-        ignisFree(swapchain->depthImageMemories, swapchain->imageCount * sizeof(VkDeviceMemory));
     }
 
+    ignisFree(swapchain->depthImages, swapchain->depthCount * sizeof(VkImage));
+    ignisFree(swapchain->depthImageViews, swapchain->depthCount * sizeof(VkImageView));
+    ignisFree(swapchain->depthImageAllocations, swapchain->depthCount * sizeof(IgnisAllocation));
+
+    swapchain->depthCount = 0;
+    swapchain->depthImages = NULL;
+    swapchain->depthImageViews = NULL;
+    swapchain->depthImageAllocations = NULL;
+}
+
+void ignisDestroySwapchain(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+{
+    /* destroy depth images */
+    ignisDestroySwapchainDepth(device, allocator, swapchain);
+
     /* destroy images */
     if (swapchain->imageViews)
     {
@@ -217,25 +292,35 @@ void ignisDestroySwapchain(VkDevice device, const VkAllocationCallbacks* allocat
 
         ignisFree(swapchain->imageViews, swapchain->imageCount * sizeof(VkImageView));
     }
+
+    /* headless swapchains own their images */
+    if (swapchain->imageAllocations)
+    {
+        for (size_t i = 0; i < swapchain->imageCount; ++i)
+        {
+            vkDestroyImage(device, swapchain->images[i], allocator);
+            ignisFreeDeviceMemory(&swapchain->imageAllocations[i]);
+        }
+        ignisFree(swapchain->imageAllocations, swapchain->imageCount * sizeof(IgnisAllocation));
+        swapchain->imageAllocations = NULL;
+    }
+
     if (swapchain->images) ignisFree(swapchain->images, swapchain->imageCount * sizeof(VkImage));
 
     /* destroy handle */
-    vkDestroySwapchainKHR(device, swapchain->handle, allocator);
+    if (swapchain->handle)
+        vkDestroySwapchainKHR(device, swapchain->handle, allocator);
 }
 
-uint8_t ignisRecreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkExtent2D extent, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain)
+uint8_t ignisRecreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain, IgnisSwapchain* retired)
 {
-    vkDeviceWaitIdle(device);
-
-    VkSwapchainKHR oldSwapchain = swapchain->handle;
-    swapchain->handle = VK_NULL_HANDLE;
-
-    ignisDestroySwapchain(device, allocator, swapchain);
-
-    uint8_t result = ignisCreateSwapchain(device, physical, surface, oldSwapchain, extent, allocator, swapchain);
+    /* old images may still be rendered to or presented */
+    *retired = *swapchain;
+    memset(swapchain, 0, sizeof(IgnisSwapchain));
 
-    vkDestroySwapchainKHR(device, oldSwapchain, allocator);
+    if (surface == VK_NULL_HANDLE)
+        return ignisCreateHeadlessSwapchain(device, physical, extent, imageCount, allocator, swapchain);
 
-    return result;
+    return ignisCreateSwapchain(device, physical, surface, retired->handle, extent, imageCount, allocator, swapchain);
 }
 
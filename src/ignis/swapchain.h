@@ -3,8 +3,6 @@
 
 #include "ignis_core.h"
 
-#define IGNIS_MAX_FRAMES_IN_FLIGHT 2
-
 typedef struct
 {
     VkSwapchainKHR handle;
@@ -17,16 +15,34 @@ typedef struct
 
     VkImage*        images;
     VkImageView*    imageViews;
+    IgnisAllocation* imageAllocations; /* only set for headless swapchains */
+
+    /* transient depth attachments, one per frame in flight */
+    uint32_t depthCount;
 
     VkImage*        depthImages;
     VkImageView*    depthImageViews;
-    VkDeviceMemory* depthImageMemories;
+    IgnisAllocation* depthImageAllocations;
 } IgnisSwapchain;
 
-uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkSwapchainKHR old, VkExtent2D extent, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
+/* imageCount of 0 requests one image more than the surface minimum, other counts are clamped to the surface limits */
+uint8_t ignisCreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkSwapchainKHR old, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
+uint8_t ignisCreateHeadlessSwapchain(VkDevice device, VkPhysicalDevice physical, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
 void ignisDestroySwapchain(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
 
-uint8_t ignisRecreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkExtent2D extent, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
+/* depth attachments are not created with the swapchain, their count follows the frames in flight */
+uint8_t ignisCreateSwapchainDepth(VkDevice device, uint32_t count, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
+void ignisDestroySwapchainDepth(VkDevice device, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain);
+
+/*
+ * Creates a new swapchain from the current one without waiting for the device.
+ * The old swapchain with its images and depth attachments is moved to retired,
+ * the caller destroys it once the frames using it have completed. The old
+ * handle is retired even if creation fails, so retired has to be destroyed
+ * either way. On failure swapchain holds whatever was created and can be
+ * passed to ignisDestroySwapchain.
+ */
+uint8_t ignisRecreateSwapchain(VkDevice device, VkPhysicalDevice physical, VkSurfaceKHR surface, VkExtent2D extent, uint32_t imageCount, const VkAllocationCallbacks* allocator, IgnisSwapchain* swapchain, IgnisSwapchain* retired);
 
 
 #endif
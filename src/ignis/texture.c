@@ -4,6 +4,9 @@
 #include "external/stb_image.h"
 
 #include "buffer.h"
+#include "upload.h"
+#include "bindless.h"
+#include "deletion_queue.h"
 
 typedef struct
 {
@@ -19,6 +22,10 @@ VK_IMAGE_LAYOUT_UNDEFINED
     access = 0;
     stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
+VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+    access = VK_ACCESS_TRANSFER_READ_BIT;
+    stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
     access = VK_ACCESS_TRANSFER_WRITE_BIT;
     stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
@@ -45,10 +52,11 @@ static VkAccessFlagBits ignisGetBarrierAccess(VkImageLayout layout)
     switch (layout)
     {
     case VK_IMAGE_LAYOUT_UNDEFINED:                 return VK_ACCESS_NONE;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:      return VK_ACCESS_TRANSFER_READ_BIT;
     case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:      return VK_ACCESS_TRANSFER_WRITE_BIT;
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:  return VK_ACCESS_SHADER_READ_BIT;
     case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:  return VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:  return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:  return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:           return VK_ACCESS_NONE;
     default:
         IGNIS_WARN("unsupported layout transition!");
@@ -61,10 +69,11 @@ static VkPipelineStageFlags ignisGetBarrierStage(VkImageLayout layout)
     switch (layout)
     {
     case VK_IMAGE_LAYOUT_UNDEFINED:                 return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:      return VK_PIPELINE_STAGE_TRANSFER_BIT;
     case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:      return VK_PIPELINE_STAGE_TRANSFER_BIT;
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:  return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:  return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:  return VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:  return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
     case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:           return VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
     default:
         IGNIS_WARN("unsupported layout transition!"); 
@@ -72,9 +81,18 @@ static VkPipelineStageFlags ignisGetBarrierStage(VkImageLayout layout)
     }
 }
 
-static VkImageAspectFlags ignisGetFormatImageAspect(VkFormat format)
+VkImageAspectFlags ignisGetFormatImageAspect(VkFormat format)
 {
-
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:          return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:  return VK_IMAGE_ASPECT_DEPTH_BIT; /* stencil is not sampled */
+    default:                            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
 }
 
 uint8_t ignisTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout, VkImageLayout newLayout)
@@ -105,6 +123,8 @@ uint8_t ignisTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image,
     return IGNIS_OK;
 }
 
+static uint8_t ignisCreateTextureViews(const IgnisTextureConfig* config, uint8_t sampled, IgnisTexture* texture);
+
 uint8_t ignisCreateTexture(const void* pixels, uint32_t width, uint32_t height, IgnisTextureConfig* configPtr, IgnisTexture* texture)
 {
     VkDevice device = ignisGetVkDevice();
@@ -112,11 +132,6 @@ uint8_t ignisCreateTexture(const void* pixels, uint32_t width, uint32_t height,
 
     IgnisTextureConfig config = configPtr ? *configPtr : IGNIS_DEFAULT_CONFIG;
 
-    VkDeviceSize imageSize = (VkDeviceSize)width * height * 4;
-
-    IgnisBuffer stagingBuffer;
-    ignisCreateBuffer(pixels, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &stagingBuffer);
-
     texture->extent = (VkExtent3D){
         .width = width,
         .height = height,
@@ -143,45 +158,43 @@ uint8_t ignisCreateTexture(const void* pixels, uint32_t width, uint32_t height,
         return IGNIS_FAIL;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(device, texture->image, &memRequirements);
-
-    texture->memory = ignisAllocateDeviceMemory(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocator);
-
-    vkBindImageMemory(device, texture->image, texture->memory, 0);
-
-    /* copy buffer to image */
-    VkCommandBuffer commandBuffer = ignisBeginOneTimeCommandBuffer();
+    if (!ignisAllocateImageMemory(texture->image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, &texture->allocation))
+    {
+        IGNIS_ERROR("failed to allocate image memory!");
+        return IGNIS_FAIL;
+    }
 
-    ignisTransitionImageLayout(commandBuffer, texture->image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    /* copy pixels to image, the graphics queue acquires it with the next frame */
+    IgnisUploadTicket ticket = ignisUploadTexture(texture, pixels);
+    if (!ticket)
+    {
+        IGNIS_ERROR("failed to upload texture data!");
+        return IGNIS_FAIL;
+    }
 
-    VkBufferImageCopy region = {
-        .bufferOffset = 0,
-        .bufferRowLength = 0,
-        .bufferImageHeight = 0,
-        .imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-        .imageSubresource.mipLevel = 0,
-        .imageSubresource.baseArrayLayer = 0,
-        .imageSubresource.layerCount = 1,
-        .imageOffset = { 0, 0, 0 },
-        .imageExtent = texture->extent
-    };
+    // batched uploads are waited for by the owner of the batch
+    if (!ignisUploadBatching())
+        ignisWaitUpload(ticket);
 
-    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.handle, texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    return ignisCreateTextureViews(&config, 1, texture);
+}
 
-    ignisTransitionImageLayout(commandBuffer, texture->image, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+static uint8_t ignisCreateTextureViews(const IgnisTextureConfig* config, uint8_t sampled, IgnisTexture* texture)
+{
+    static uint32_t textureIds = 0;
 
-    ignisEndOneTimeCommandBuffer(commandBuffer);
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
-    ignisDestroyBuffer(&stagingBuffer);
+    texture->id = ++textureIds;
 
     /* create image view */
     VkImageViewCreateInfo viewInfo = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .image = texture->image,
         .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format = config.format,
-        .subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+        .format = config->format,
+        .subresourceRange.aspectMask = ignisGetFormatImageAspect(config->format),
         .subresourceRange.baseMipLevel = 0,
         .subresourceRange.levelCount = 1,
         .subresourceRange.baseArrayLayer = 0,
@@ -194,14 +207,22 @@ uint8_t ignisCreateTexture(const void* pixels, uint32_t width, uint32_t height,
         return IGNIS_FAIL;
     }
 
+    /* attachments that are not sampled only need the view */
+    if (!sampled)
+    {
+        texture->sampler = VK_NULL_HANDLE;
+        texture->index = IGNIS_BINDLESS_INVALID_INDEX;
+        return IGNIS_OK;
+    }
+
     /* create sampler */
     VkSamplerCreateInfo samplerInfo = {
         .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-        .minFilter = config.minFilter,
-        .magFilter = config.magFilter,
-        .addressModeU = config.addressMode,
-        .addressModeV = config.addressMode,
-        .addressModeW = config.addressMode,
+        .minFilter = config->minFilter,
+        .magFilter = config->magFilter,
+        .addressModeU = config->addressMode,
+        .addressModeV = config->addressMode,
+        .addressModeW = config->addressMode,
         .anisotropyEnable = VK_TRUE,
         .maxAnisotropy = ignisGetMaxSamplerAnisotropy(),
         .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
@@ -220,9 +241,55 @@ uint8_t ignisCreateTexture(const void* pixels, uint32_t width, uint32_t height,
         return IGNIS_FAIL;
     }
 
+    texture->index = ignisBindlessAddTexture(texture->view, texture->sampler);
+
     return IGNIS_OK;
 }
 
+uint8_t ignisCreateAttachmentTexture(uint32_t width, uint32_t height, VkImageUsageFlags usage, VkSampleCountFlagBits samples, IgnisTextureConfig* configPtr, IgnisTexture* texture)
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    IgnisTextureConfig config = configPtr ? *configPtr : IGNIS_DEFAULT_CONFIG;
+
+    texture->extent = (VkExtent3D){
+        .width = width,
+        .height = height,
+        .depth = 1
+    };
+
+    VkImageCreateInfo imageInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .extent = texture->extent,
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .format = config.format,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .usage = usage,
+        .samples = samples,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE
+    };
+
+    if (vkCreateImage(device, &imageInfo, allocator, &texture->image) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create image!");
+        return IGNIS_FAIL;
+    }
+
+    // transient attachments never leave tile memory on tiled gpus
+    VkMemoryPropertyFlags preferred = (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+    if (!ignisAllocateImageMemory(texture->image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, preferred, &texture->allocation))
+    {
+        IGNIS_ERROR("failed to allocate image memory!");
+        return IGNIS_FAIL;
+    }
+
+    return ignisCreateTextureViews(&config, (usage & VK_IMAGE_USAGE_SAMPLED_BIT) != 0, texture);
+}
+
 uint8_t ignisLoadTexture(const char* path, IgnisTextureConfig* configPtr, uint8_t flipOnLoad, IgnisTexture* texture)
 {
     size_t dataSize;
@@ -253,14 +320,24 @@ uint8_t ignisLoadTexture(const char* path, IgnisTextureConfig* configPtr, uint8_
     return result;
 }
 
-void ignisDestroyTexture(IgnisTexture* texture)
+static void ignisDeleteTexture(void* object)
 {
+    IgnisTexture* texture = object;
+
     VkDevice device = ignisGetVkDevice();
     const VkAllocationCallbacks* allocator = ignisGetAllocator();
 
+    // the slot is only reused once no frame can read it anymore
+    ignisBindlessRemoveTexture(texture->index);
+
     vkDestroySampler(device, texture->sampler, allocator);
     vkDestroyImageView(device, texture->view, allocator);
 
     vkDestroyImage(device, texture->image, allocator);
-    vkFreeMemory(device, texture->memory, allocator);
+    ignisFreeDeviceMemory(&texture->allocation);
+}
+
+void ignisDestroyTexture(IgnisTexture* texture)
+{
+    ignisDeferObject(ignisDeleteTexture, texture, sizeof(IgnisTexture));
 }
\ No newline at end of file
@@ -19,10 +19,13 @@ typedef struct
 {
     VkImage image;
     VkImageView view;
-    VkDeviceMemory memory;
+    IgnisAllocation allocation;
 
     VkSampler sampler;
     VkExtent3D extent;
+
+    uint32_t index; /* slot in the bindless texture table */
+    uint32_t id;    /* unique per created texture, unlike the reused handles */
 } IgnisTexture;
 
 
@@ -31,6 +34,15 @@ void ignisDestroyTexture(IgnisTexture* texture);
 
 uint8_t ignisLoadTexture(const char* path, IgnisTextureConfig* configPtr, uint8_t flipOnLoad, IgnisTexture* texture);
 
+/*
+ * Texture without initial data to render into. Only sampled attachments get
+ * a sampler and a bindless slot, transient ones prefer lazily allocated memory.
+ */
+uint8_t ignisCreateAttachmentTexture(uint32_t width, uint32_t height, VkImageUsageFlags usage, VkSampleCountFlagBits samples, IgnisTextureConfig* configPtr, IgnisTexture* texture);
+
+/* depth for depth formats, color otherwise */
+VkImageAspectFlags ignisGetFormatImageAspect(VkFormat format);
+
 uint8_t ignisTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout, VkImageLayout newLayout);
 
 #endif // !IGNIS_TEXTURE_H
\ No newline at end of file
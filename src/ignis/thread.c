@@ -0,0 +1,271 @@
+#include "thread.h"
+
+#ifdef WINDOWS
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* --------------------------| primitives |------------------------------ */
+#ifdef WINDOWS
+
+struct IgnisMutex     { SRWLOCK lock; };
+struct IgnisCondition { CONDITION_VARIABLE cond; };
+
+typedef HANDLE IgnisThread;
+
+IgnisMutex* ignisCreateMutex()
+{
+    IgnisMutex* mutex = ignisAlloc(sizeof(IgnisMutex));
+    if (mutex) InitializeSRWLock(&mutex->lock);
+    return mutex;
+}
+
+void ignisDestroyMutex(IgnisMutex* mutex) { ignisFree(mutex, sizeof(IgnisMutex)); }
+
+void ignisLockMutex(IgnisMutex* mutex)   { AcquireSRWLockExclusive(&mutex->lock); }
+void ignisUnlockMutex(IgnisMutex* mutex) { ReleaseSRWLockExclusive(&mutex->lock); }
+
+IgnisCondition* ignisCreateCondition()
+{
+    IgnisCondition* condition = ignisAlloc(sizeof(IgnisCondition));
+    if (condition) InitializeConditionVariable(&condition->cond);
+    return condition;
+}
+
+void ignisDestroyCondition(IgnisCondition* condition) { ignisFree(condition, sizeof(IgnisCondition)); }
+
+void ignisWaitCondition(IgnisCondition* condition, IgnisMutex* mutex)
+{
+    SleepConditionVariableSRW(&condition->cond, &mutex->lock, INFINITE, 0);
+}
+
+void ignisSignalCondition(IgnisCondition* condition)    { WakeConditionVariable(&condition->cond); }
+void ignisBroadcastCondition(IgnisCondition* condition) { WakeAllConditionVariable(&condition->cond); }
+
+uint32_t ignisGetCoreCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+
+#else
+
+struct IgnisMutex     { pthread_mutex_t lock; };
+struct IgnisCondition { pthread_cond_t cond; };
+
+typedef pthread_t IgnisThread;
+
+IgnisMutex* ignisCreateMutex()
+{
+    IgnisMutex* mutex = ignisAlloc(sizeof(IgnisMutex));
+    if (mutex) pthread_mutex_init(&mutex->lock, NULL);
+    return mutex;
+}
+
+void ignisDestroyMutex(IgnisMutex* mutex)
+{
+    if (!mutex) return;
+    pthread_mutex_destroy(&mutex->lock);
+    ignisFree(mutex, sizeof(IgnisMutex));
+}
+
+void ignisLockMutex(IgnisMutex* mutex)   { pthread_mutex_lock(&mutex->lock); }
+void ignisUnlockMutex(IgnisMutex* mutex) { pthread_mutex_unlock(&mutex->lock); }
+
+IgnisCondition* ignisCreateCondition()
+{
+    IgnisCondition* condition = ignisAlloc(sizeof(IgnisCondition));
+    if (condition) pthread_cond_init(&condition->cond, NULL);
+    return condition;
+}
+
+void ignisDestroyCondition(IgnisCondition* condition)
+{
+    if (!condition) return;
+    pthread_cond_destroy(&condition->cond);
+    ignisFree(condition, sizeof(IgnisCondition));
+}
+
+void ignisWaitCondition(IgnisCondition* condition, IgnisMutex* mutex)
+{
+    pthread_cond_wait(&condition->cond, &mutex->lock);
+}
+
+void ignisSignalCondition(IgnisCondition* condition)    { pthread_cond_signal(&condition->cond); }
+void ignisBroadcastCondition(IgnisCondition* condition) { pthread_cond_broadcast(&condition->cond); }
+
+uint32_t ignisGetCoreCount()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+}
+
+#endif
+
+/* --------------------------| worker pool |----------------------------- */
+typedef struct IgnisJob
+{
+    IgnisJobFunc func;
+    void* arg;
+    struct IgnisJob* next;
+} IgnisJob;
+
+static struct IgnisWorkerPool
+{
+    IgnisThread threads[IGNIS_MAX_WORKERS];
+    uint32_t threadCount;
+
+    IgnisMutex* mutex;
+    IgnisCondition* wake;
+
+    /* fifo of pending jobs */
+    IgnisJob* head;
+    IgnisJob* tail;
+
+    uint8_t running;
+} workers;
+
+static void ignisWorkerLoop()
+{
+    ignisLockMutex(workers.mutex);
+    for (;;)
+    {
+        while (!workers.head && workers.running)
+            ignisWaitCondition(workers.wake, workers.mutex);
+
+        // pending jobs are finished before shutting down
+        IgnisJob* job = workers.head;
+        if (!job) break;
+
+        workers.head = job->next;
+        if (!workers.head) workers.tail = NULL;
+
+        ignisUnlockMutex(workers.mutex);
+
+        job->func(job->arg);
+        ignisFree(job, sizeof(IgnisJob));
+
+        ignisLockMutex(workers.mutex);
+    }
+    ignisUnlockMutex(workers.mutex);
+}
+
+#ifdef WINDOWS
+static DWORD WINAPI ignisWorkerMain(LPVOID arg) { ignisWorkerLoop(); return 0; }
+#else
+static void* ignisWorkerMain(void* arg) { ignisWorkerLoop(); return NULL; }
+#endif
+
+uint8_t ignisCreateWorkerPool(uint32_t threadCount)
+{
+    memset(&workers, 0, sizeof(workers));
+
+    if (!threadCount)
+    {
+        uint32_t cores = ignisGetCoreCount();
+        threadCount = cores > 1 ? cores - 1 : 1;
+    }
+
+    if (threadCount > IGNIS_MAX_WORKERS)
+        threadCount = IGNIS_MAX_WORKERS;
+
+    workers.mutex = ignisCreateMutex();
+    workers.wake = ignisCreateCondition();
+    if (!workers.mutex || !workers.wake)
+        return IGNIS_FAIL;
+
+    workers.running = 1;
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+#ifdef WINDOWS
+        workers.threads[i] = CreateThread(NULL, 0, ignisWorkerMain, NULL, 0, NULL);
+        uint8_t created = workers.threads[i] != NULL;
+#else
+        uint8_t created = pthread_create(&workers.threads[i], NULL, ignisWorkerMain, NULL) == 0;
+#endif
+        if (!created)
+        {
+            IGNIS_WARN("Failed to create worker thread %d", i);
+            break;
+        }
+        workers.threadCount++;
+    }
+
+    if (!workers.threadCount)
+        return IGNIS_FAIL;
+
+    IGNIS_TRACE("Created %d worker threads", workers.threadCount);
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyWorkerPool()
+{
+    if (!workers.mutex) return;
+
+    ignisLockMutex(workers.mutex);
+    workers.running = 0;
+    ignisBroadcastCondition(workers.wake);
+    ignisUnlockMutex(workers.mutex);
+
+    for (uint32_t i = 0; i < workers.threadCount; ++i)
+    {
+#ifdef WINDOWS
+        WaitForSingleObject(workers.threads[i], INFINITE);
+        CloseHandle(workers.threads[i]);
+#else
+        pthread_join(workers.threads[i], NULL);
+#endif
+    }
+
+    ignisDestroyCondition(workers.wake);
+    ignisDestroyMutex(workers.mutex);
+
+    memset(&workers, 0, sizeof(workers));
+}
+
+static uint8_t ignisQueueJob(IgnisJobFunc func, void* arg, uint8_t priority)
+{
+    // without workers the job runs on the calling thread
+    if (!workers.threadCount)
+    {
+        func(arg);
+        return IGNIS_OK;
+    }
+
+    IgnisJob* job = ignisAlloc(sizeof(IgnisJob));
+    if (!job) return IGNIS_FAIL;
+
+    job->func = func;
+    job->arg = arg;
+    job->next = NULL;
+
+    ignisLockMutex(workers.mutex);
+
+    if (priority)
+    {
+        job->next = workers.head;
+        workers.head = job;
+        if (!workers.tail) workers.tail = job;
+    }
+    else
+    {
+        if (workers.tail) workers.tail->next = job;
+        else              workers.head = job;
+        workers.tail = job;
+    }
+
+    ignisSignalCondition(workers.wake);
+    ignisUnlockMutex(workers.mutex);
+
+    return IGNIS_OK;
+}
+
+uint8_t ignisSubmitJob(IgnisJobFunc func, void* arg)         { return ignisQueueJob(func, arg, 0); }
+uint8_t ignisSubmitPriorityJob(IgnisJobFunc func, void* arg) { return ignisQueueJob(func, arg, 1); }
+
+uint32_t ignisGetWorkerCount() { return workers.threadCount; }
@@ -0,0 +1,43 @@
+#ifndef IGNIS_THREAD_H
+#define IGNIS_THREAD_H
+
+#include "common.h"
+
+/* --------------------------| primitives |------------------------------ */
+typedef struct IgnisMutex IgnisMutex;
+typedef struct IgnisCondition IgnisCondition;
+
+IgnisMutex* ignisCreateMutex();
+void ignisDestroyMutex(IgnisMutex* mutex);
+
+void ignisLockMutex(IgnisMutex* mutex);
+void ignisUnlockMutex(IgnisMutex* mutex);
+
+IgnisCondition* ignisCreateCondition();
+void ignisDestroyCondition(IgnisCondition* condition);
+
+void ignisWaitCondition(IgnisCondition* condition, IgnisMutex* mutex);
+void ignisSignalCondition(IgnisCondition* condition);
+void ignisBroadcastCondition(IgnisCondition* condition);
+
+uint32_t ignisGetCoreCount();
+
+/* --------------------------| worker pool |----------------------------- */
+#define IGNIS_MAX_WORKERS 16
+
+typedef void (*IgnisJobFunc)(void* arg);
+
+/* threadCount of 0 uses one thread per core, except for the calling one */
+uint8_t ignisCreateWorkerPool(uint32_t threadCount);
+
+/* waits for all submitted jobs to finish */
+void ignisDestroyWorkerPool();
+
+uint8_t ignisSubmitJob(IgnisJobFunc func, void* arg);
+
+/* queued in front of all pending jobs, for work a frame waits on */
+uint8_t ignisSubmitPriorityJob(IgnisJobFunc func, void* arg);
+
+uint32_t ignisGetWorkerCount();
+
+#endif /* !IGNIS_THREAD_H */
@@ -0,0 +1,700 @@
+#include "upload.h"
+
+/* offsets into the staging ring are aligned for buffer to image copies */
+#define IGNIS_STAGING_ALIGNMENT 16
+
+typedef struct
+{
+    IgnisUploadTicket ticket;
+    VkCommandBuffer commandBuffer;
+
+    VkDeviceSize ringEnd; /* staging ring position after this submit */
+} IgnisUploadSubmit;
+
+/* copy from the staging ring, recorded when the batch is submitted */
+typedef struct
+{
+    VkBuffer buffer;
+    VkBufferCopy bufferRegion;
+
+    VkImage image;
+    VkBufferImageCopy imageRegion;
+
+    uint8_t first;  /* first copy into the image, needs a layout transition */
+    uint8_t last;   /* completes the resource, ownership is released after it */
+
+    VkDeviceSize offset; /* buffer range to release */
+    VkDeviceSize size;
+} IgnisUploadCopy;
+
+/* resources waiting for the graphics queue to acquire ownership */
+typedef struct
+{
+    IgnisUploadTicket ticket;
+
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+
+    VkImage image;
+} IgnisUploadAcquire;
+
+static struct IgnisUploadQueue
+{
+    VkQueue queue;
+    VkCommandPool commandPool;
+    VkSemaphore timeline;
+
+    uint32_t srcFamily; /* transfer */
+    uint32_t dstFamily; /* graphics */
+
+    /*
+     * Persistently mapped staging ring shared by all uploads. Head and
+     * tail grow until the ring runs empty, positions are taken modulo
+     * the capacity. The tail advances as submits are collected.
+     */
+    IgnisBuffer staging;
+    VkDeviceSize capacity;
+    VkDeviceSize ringHead;
+    VkDeviceSize ringTail;
+
+    IgnisUploadTicket submitted;
+    IgnisUploadTicket acquired;
+
+    IgnisUploadSubmit* submits;
+    uint32_t submitCount;
+    uint32_t submitCapacity;
+
+    IgnisUploadAcquire* acquires;
+    uint32_t acquireCount;
+    uint32_t acquireCapacity;
+
+    /* copies of the open batch */
+    uint8_t batching;
+    IgnisUploadCopy* copies;
+    uint32_t copyCount;
+    uint32_t copyCapacity;
+
+    /* start of the current upload, restored if it fails */
+    uint32_t markCopy;
+    VkDeviceSize markRing;
+    uint8_t markFlushed; /* some of its copies are submitted already */
+} uploads;
+
+uint8_t ignisCreateUploadQueue(VkDeviceSize stagingSize)
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    memset(&uploads, 0, sizeof(uploads));
+
+    uploads.queue = ignisGetQueue(IGNIS_QUEUE_TRANSFER);
+    uploads.srcFamily = ignisGetQueueFamilyIndex(IGNIS_QUEUE_TRANSFER);
+    uploads.dstFamily = ignisGetQueueFamilyIndex(IGNIS_QUEUE_GRAPHICS);
+
+    VkCommandPoolCreateInfo poolInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = uploads.srcFamily
+    };
+
+    if (vkCreateCommandPool(device, &poolInfo, allocator, &uploads.commandPool) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create upload command pool!");
+        return IGNIS_FAIL;
+    }
+
+    VkSemaphoreTypeCreateInfo timelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0
+    };
+
+    VkSemaphoreCreateInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timelineInfo
+    };
+
+    if (vkCreateSemaphore(device, &semaphoreInfo, allocator, &uploads.timeline) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to create upload timeline semaphore!");
+        return IGNIS_FAIL;
+    }
+
+    uploads.capacity = (stagingSize + IGNIS_STAGING_ALIGNMENT - 1) & ~(VkDeviceSize)(IGNIS_STAGING_ALIGNMENT - 1);
+    if (!ignisCreateBuffer(NULL, uploads.capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &uploads.staging))
+    {
+        IGNIS_ERROR("failed to create staging buffer!");
+        return IGNIS_FAIL;
+    }
+
+    return IGNIS_OK;
+}
+
+void ignisDestroyUploadQueue()
+{
+    VkDevice device = ignisGetVkDevice();
+    const VkAllocationCallbacks* allocator = ignisGetAllocator();
+
+    if (uploads.batching)
+        ignisEndUploadBatch();
+
+    ignisWaitUpload(uploads.submitted);
+
+    ignisDestroyBuffer(&uploads.staging);
+
+    ignisFree(uploads.copies, uploads.copyCapacity * sizeof(IgnisUploadCopy));
+    ignisFree(uploads.submits, uploads.submitCapacity * sizeof(IgnisUploadSubmit));
+    ignisFree(uploads.acquires, uploads.acquireCapacity * sizeof(IgnisUploadAcquire));
+
+    vkDestroySemaphore(device, uploads.timeline, allocator);
+    vkDestroyCommandPool(device, uploads.commandPool, allocator);
+}
+
+static VkCommandBuffer ignisBeginUpload()
+{
+    VkCommandBufferAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandPool = uploads.commandPool,
+        .commandBufferCount = 1
+    };
+
+    VkCommandBuffer commandBuffer;
+    if (vkAllocateCommandBuffers(ignisGetVkDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to allocate upload command buffer!");
+        return VK_NULL_HANDLE;
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+    };
+
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    return commandBuffer;
+}
+
+static IgnisUploadTicket ignisSubmitUpload(VkCommandBuffer commandBuffer)
+{
+    vkEndCommandBuffer(commandBuffer);
+
+    IgnisUploadTicket ticket = uploads.submitted + 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &ticket
+    };
+
+    VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timelineInfo,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &uploads.timeline
+    };
+
+    if (vkQueueSubmit(uploads.queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        IGNIS_ERROR("failed to submit upload!");
+        vkFreeCommandBuffers(ignisGetVkDevice(), uploads.commandPool, 1, &commandBuffer);
+
+        // drop the staged data once older uploads are done with the ring
+        ignisWaitUpload(uploads.submitted);
+        uploads.ringTail = uploads.ringHead;
+        return 0;
+    }
+
+    uploads.submitted = ticket;
+
+    if (!ignisReserve((void**)&uploads.submits, &uploads.submitCapacity, uploads.submitCount + 1, sizeof(IgnisUploadSubmit)))
+    {
+        /* can not track the submit, so finish it right away */
+        ignisWaitUpload(ticket);
+        vkFreeCommandBuffers(ignisGetVkDevice(), uploads.commandPool, 1, &commandBuffer);
+        uploads.ringTail = uploads.ringHead;
+        return ticket;
+    }
+
+    uploads.submits[uploads.submitCount++] = (IgnisUploadSubmit){
+        .ticket = ticket,
+        .commandBuffer = commandBuffer,
+        .ringEnd = uploads.ringHead
+    };
+
+    return ticket;
+}
+
+/* copy data into the staging ring, waits for older uploads if the ring is full */
+static uint8_t ignisStageData(const void* data, VkDeviceSize size, VkDeviceSize* offset)
+{
+    VkDeviceSize aligned = (size + IGNIS_STAGING_ALIGNMENT - 1) & ~(VkDeviceSize)(IGNIS_STAGING_ALIGNMENT - 1);
+    if (aligned > uploads.capacity)
+        return IGNIS_FAIL;
+
+    VkDeviceSize padding = 0;
+    for (;;)
+    {
+        // nothing in flight, start again at the beginning of the ring
+        if (uploads.ringHead == uploads.ringTail)
+            uploads.ringHead = uploads.ringTail = uploads.markRing = 0;
+
+        // allocations never wrap around the end of the ring
+        VkDeviceSize position = uploads.ringHead % uploads.capacity;
+        padding = position + aligned > uploads.capacity ? uploads.capacity - position : 0;
+
+        if (uploads.capacity - (uploads.ringHead - uploads.ringTail) >= padding + aligned)
+            break;
+
+        // remaining space is held by copies that are not submitted yet
+        if (!uploads.submitCount)
+            return IGNIS_FAIL;
+
+        ignisWaitUpload(uploads.submits[0].ticket);
+    }
+
+    uploads.ringHead += padding;
+    *offset = uploads.ringHead % uploads.capacity;
+    uploads.ringHead += aligned;
+
+    if (data) memcpy((uint8_t*)uploads.staging.allocation.data + *offset, data, size);
+
+    return IGNIS_OK;
+}
+
+static void ignisPushAcquire(IgnisUploadAcquire acquire)
+{
+    if (!ignisReserve((void**)&uploads.acquires, &uploads.acquireCapacity, uploads.acquireCount + 1, sizeof(IgnisUploadAcquire)))
+    {
+        IGNIS_ERROR("failed to queue ownership transfer!");
+        return;
+    }
+
+    uploads.acquires[uploads.acquireCount++] = acquire;
+}
+
+static const VkImageSubresourceRange IGNIS_UPLOAD_SUBRESOURCE = {
+    .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+    .baseMipLevel = 0,
+    .levelCount = 1,
+    .baseArrayLayer = 0,
+    .layerCount = 1
+};
+
+/* record all queued copies into one command buffer and submit it */
+static IgnisUploadTicket ignisFlushUploads()
+{
+    if (!uploads.copyCount) return uploads.submitted;
+
+    uint32_t count = uploads.copyCount;
+    uploads.copyCount = 0;
+
+    // the staged data now belongs to the submit
+    uploads.markCopy = 0;
+    uploads.markRing = uploads.ringHead;
+    uploads.markFlushed = 1;
+
+    VkCommandBuffer commandBuffer = ignisBeginUpload();
+
+    VkBufferMemoryBarrier* bufferBarriers = ignisAlloc(count * sizeof(VkBufferMemoryBarrier));
+    VkImageMemoryBarrier* imageBarriers = ignisAlloc(count * sizeof(VkImageMemoryBarrier));
+
+    if (!commandBuffer || !bufferBarriers || !imageBarriers)
+    {
+        IGNIS_ERROR("failed to record upload batch!");
+        if (commandBuffer) vkFreeCommandBuffers(ignisGetVkDevice(), uploads.commandPool, 1, &commandBuffer);
+        if (bufferBarriers) ignisFree(bufferBarriers, count * sizeof(VkBufferMemoryBarrier));
+        if (imageBarriers) ignisFree(imageBarriers, count * sizeof(VkImageMemoryBarrier));
+
+        ignisWaitUpload(uploads.submitted);
+        uploads.ringTail = uploads.ringHead;
+        return 0;
+    }
+
+    /* transition all images that are written for the first time */
+    uint32_t imageCount = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IgnisUploadCopy* copy = &uploads.copies[i];
+        if (!copy->image || !copy->first) continue;
+
+        imageBarriers[imageCount++] = (VkImageMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = copy->image,
+            .subresourceRange = IGNIS_UPLOAD_SUBRESOURCE
+        };
+    }
+
+    if (imageCount)
+    {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, NULL, 0, NULL, imageCount, imageBarriers);
+    }
+
+    /* copies */
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IgnisUploadCopy* copy = &uploads.copies[i];
+        if (copy->image)
+            vkCmdCopyBufferToImage(commandBuffer, uploads.staging.handle, copy->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy->imageRegion);
+        else
+            vkCmdCopyBuffer(commandBuffer, uploads.staging.handle, copy->buffer, 1, &copy->bufferRegion);
+    }
+
+    /* release ownership of completed resources to the graphics queue */
+    uint8_t sameFamily = uploads.srcFamily == uploads.dstFamily;
+    uint32_t srcFamily = sameFamily ? VK_QUEUE_FAMILY_IGNORED : uploads.srcFamily;
+    uint32_t dstFamily = sameFamily ? VK_QUEUE_FAMILY_IGNORED : uploads.dstFamily;
+
+    uint32_t bufferCount = 0;
+    imageCount = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IgnisUploadCopy* copy = &uploads.copies[i];
+        if (!copy->last) continue;
+
+        if (copy->image)
+        {
+            // the layout transition happens on both sides
+            imageBarriers[imageCount++] = (VkImageMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = sameFamily ? VK_ACCESS_SHADER_READ_BIT : 0,
+                .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .srcQueueFamilyIndex = srcFamily,
+                .dstQueueFamilyIndex = dstFamily,
+                .image = copy->image,
+                .subresourceRange = IGNIS_UPLOAD_SUBRESOURCE
+            };
+        }
+        else
+        {
+            bufferBarriers[bufferCount++] = (VkBufferMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = sameFamily ? VK_ACCESS_MEMORY_READ_BIT : 0,
+                .srcQueueFamilyIndex = srcFamily,
+                .dstQueueFamilyIndex = dstFamily,
+                .buffer = copy->buffer,
+                .offset = copy->offset,
+                .size = copy->size
+            };
+        }
+    }
+
+    if (bufferCount || imageCount)
+    {
+        VkPipelineStageFlags dstStage = sameFamily ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0,
+            0, NULL, bufferCount, bufferBarriers, imageCount, imageBarriers);
+    }
+
+    ignisFree(bufferBarriers, count * sizeof(VkBufferMemoryBarrier));
+    ignisFree(imageBarriers, count * sizeof(VkImageMemoryBarrier));
+
+    IgnisUploadTicket ticket = ignisSubmitUpload(commandBuffer);
+    if (!ticket) return 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        IgnisUploadCopy* copy = &uploads.copies[i];
+        if (!copy->last) continue;
+
+        ignisPushAcquire((IgnisUploadAcquire){
+            .ticket = ticket,
+            .buffer = copy->buffer,
+            .offset = copy->offset,
+            .size = copy->size,
+            .image = copy->image
+        });
+    }
+
+    return ticket;
+}
+
+/* stage data and queue the copy, submits the open batch if the ring is full */
+static uint8_t ignisQueueCopy(IgnisUploadCopy copy, const void* data, VkDeviceSize size)
+{
+    VkDeviceSize offset = 0;
+    if (!ignisStageData(data, size, &offset))
+    {
+        if (!uploads.copyCount || !ignisFlushUploads() || !ignisStageData(data, size, &offset))
+            return IGNIS_FAIL;
+    }
+
+    if (copy.image) copy.imageRegion.bufferOffset = offset;
+    else            copy.bufferRegion.srcOffset = offset;
+
+    if (!ignisReserve((void**)&uploads.copies, &uploads.copyCapacity, uploads.copyCount + 1, sizeof(IgnisUploadCopy)))
+        return IGNIS_FAIL;
+
+    uploads.copies[uploads.copyCount++] = copy;
+    return IGNIS_OK;
+}
+
+void ignisBeginUploadBatch()
+{
+    if (uploads.batching)
+        IGNIS_WARN("upload batch is already open");
+
+    uploads.batching = 1;
+}
+
+IgnisUploadTicket ignisEndUploadBatch()
+{
+    uploads.batching = 0;
+    return ignisFlushUploads();
+}
+
+uint8_t ignisUploadBatching() { return uploads.batching; }
+
+static void ignisStartUpload()
+{
+    uploads.markCopy = uploads.copyCount;
+    uploads.markRing = uploads.ringHead;
+    uploads.markFlushed = 0;
+}
+
+/* uploads outside of a batch are submitted right away */
+static IgnisUploadTicket ignisFinishUpload(uint8_t queued)
+{
+    if (!queued)
+    {
+        // drop the copies and staged data of this upload, earlier copies of an open batch stay queued
+        uploads.copyCount = uploads.markCopy;
+        uploads.ringHead = uploads.markRing;
+
+        if (uploads.markFlushed)
+            IGNIS_ERROR("failed upload was partially submitted, the resource has to be discarded");
+
+        return 0;
+    }
+
+    // queued copies are part of the next submit
+    return uploads.batching ? uploads.submitted + 1 : ignisFlushUploads();
+}
+
+IgnisUploadTicket ignisUploadBuffer(IgnisBuffer* buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    const uint8_t* bytes = data;
+
+    ignisStartUpload();
+
+    // payloads bigger than the ring are split into chunks
+    uint8_t queued = IGNIS_OK;
+    VkDeviceSize copied = 0;
+    while (queued && copied < size)
+    {
+        VkDeviceSize chunk = size - copied;
+        if (chunk > uploads.capacity) chunk = uploads.capacity;
+
+        IgnisUploadCopy copy = {
+            .buffer = buffer->handle,
+            .bufferRegion = {
+                .dstOffset = offset + copied,
+                .size = chunk
+            },
+            .last = copied + chunk >= size,
+            .offset = offset,
+            .size = size
+        };
+
+        queued = ignisQueueCopy(copy, bytes ? bytes + copied : NULL, chunk);
+        copied += chunk;
+    }
+
+    if (!queued) IGNIS_ERROR("failed to stage buffer data!");
+
+    return ignisFinishUpload(queued);
+}
+
+IgnisUploadTicket ignisUploadTexture(IgnisTexture* texture, const void* pixels)
+{
+    const uint8_t* bytes = pixels;
+
+    VkDeviceSize rowSize = (VkDeviceSize)texture->extent.width * 4;
+    uint32_t maxRows = (uint32_t)(uploads.capacity / rowSize);
+    if (!maxRows)
+    {
+        IGNIS_ERROR("texture rows do not fit into the staging ring!");
+        return 0;
+    }
+
+    ignisStartUpload();
+
+    // payloads bigger than the ring are split into chunks of rows
+    uint8_t queued = IGNIS_OK;
+    uint32_t row = 0;
+    while (queued && row < texture->extent.height)
+    {
+        uint32_t rows = texture->extent.height - row;
+        if (rows > maxRows) rows = maxRows;
+
+        IgnisUploadCopy copy = {
+            .image = texture->image,
+            .imageRegion = {
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .imageSubresource.mipLevel = 0,
+                .imageSubresource.baseArrayLayer = 0,
+                .imageSubresource.layerCount = 1,
+                .imageOffset = { 0, (int32_t)row, 0 },
+                .imageExtent = { texture->extent.width, rows, 1 }
+            },
+            .first = row == 0,
+            .last = row + rows >= texture->extent.height
+        };
+
+        queued = ignisQueueCopy(copy, bytes ? bytes + row * rowSize : NULL, rows * rowSize);
+        row += rows;
+    }
+
+    if (!queued) IGNIS_ERROR("failed to stage texture data!");
+
+    return ignisFinishUpload(queued);
+}
+
+uint8_t ignisUploadComplete(IgnisUploadTicket ticket)
+{
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(ignisGetVkDevice(), uploads.timeline, &value);
+    return value >= ticket;
+}
+
+uint8_t ignisUploadReady(IgnisUploadTicket ticket)
+{
+    return ticket && ticket <= uploads.acquired;
+}
+
+void ignisWaitUpload(IgnisUploadTicket ticket)
+{
+    if (!ticket || ticket > uploads.submitted) return;
+
+    VkSemaphoreWaitInfo waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &uploads.timeline,
+        .pValues = &ticket
+    };
+
+    vkWaitSemaphores(ignisGetVkDevice(), &waitInfo, UINT64_MAX);
+
+    ignisCollectUploads();
+}
+
+void ignisCollectUploads()
+{
+    VkDevice device = ignisGetVkDevice();
+
+    uint64_t completed = 0;
+    vkGetSemaphoreCounterValue(device, uploads.timeline, &completed);
+
+    /* submits are stored in ticket order */
+    uint32_t count = 0;
+    while (count < uploads.submitCount && uploads.submits[count].ticket <= completed)
+    {
+        IgnisUploadSubmit* submit = &uploads.submits[count++];
+
+        vkFreeCommandBuffers(device, uploads.commandPool, 1, &submit->commandBuffer);
+        uploads.ringTail = submit->ringEnd;
+    }
+
+    uploads.submitCount -= count;
+    memmove(uploads.submits, uploads.submits + count, uploads.submitCount * sizeof(IgnisUploadSubmit));
+}
+
+uint64_t ignisAcquireUploads(VkCommandBuffer commandBuffer)
+{
+    if (!uploads.acquireCount) return 0;
+
+    uint64_t completed = 0;
+    vkGetSemaphoreCounterValue(ignisGetVkDevice(), uploads.timeline, &completed);
+
+    /* only take over finished uploads, so the frame never waits on the transfer queue */
+    uint32_t count = 0;
+    while (count < uploads.acquireCount && uploads.acquires[count].ticket <= completed) ++count;
+
+    if (!count) return 0;
+
+    if (uploads.srcFamily != uploads.dstFamily)
+    {
+        VkBufferMemoryBarrier* bufferBarriers = ignisAlloc(count * sizeof(VkBufferMemoryBarrier));
+        VkImageMemoryBarrier* imageBarriers = ignisAlloc(count * sizeof(VkImageMemoryBarrier));
+
+        if (!bufferBarriers || !imageBarriers)
+        {
+            IGNIS_ERROR("failed to record ownership transfers!");
+            if (bufferBarriers) ignisFree(bufferBarriers, count * sizeof(VkBufferMemoryBarrier));
+            if (imageBarriers) ignisFree(imageBarriers, count * sizeof(VkImageMemoryBarrier));
+            return 0;
+        }
+
+        uint32_t bufferCount = 0;
+        uint32_t imageCount = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            IgnisUploadAcquire* acquire = &uploads.acquires[i];
+            if (acquire->image)
+            {
+                imageBarriers[imageCount++] = (VkImageMemoryBarrier){
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = 0,
+                    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    .srcQueueFamilyIndex = uploads.srcFamily,
+                    .dstQueueFamilyIndex = uploads.dstFamily,
+                    .image = acquire->image,
+                    .subresourceRange = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                    }
+                };
+            }
+            else
+            {
+                bufferBarriers[bufferCount++] = (VkBufferMemoryBarrier){
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                    .srcAccessMask = 0,
+                    .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT,
+                    .srcQueueFamilyIndex = uploads.srcFamily,
+                    .dstQueueFamilyIndex = uploads.dstFamily,
+                    .buffer = acquire->buffer,
+                    .offset = acquire->offset,
+                    .size = acquire->size
+                };
+            }
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+            0, NULL, bufferCount, bufferBarriers, imageCount, imageBarriers);
+
+        ignisFree(bufferBarriers, count * sizeof(VkBufferMemoryBarrier));
+        ignisFree(imageBarriers, count * sizeof(VkImageMemoryBarrier));
+    }
+
+    uint64_t value = uploads.acquires[count - 1].ticket;
+    uploads.acquired = value;
+
+    uploads.acquireCount -= count;
+    memmove(uploads.acquires, uploads.acquires + count, uploads.acquireCount * sizeof(IgnisUploadAcquire));
+
+    return value;
+}
+
+VkSemaphore ignisGetUploadSemaphore() { return uploads.timeline; }
@@ -0,0 +1,56 @@
+#ifndef IGNIS_UPLOAD_H
+#define IGNIS_UPLOAD_H
+
+#include "ignis_core.h"
+
+#include "buffer.h"
+#include "texture.h"
+
+/*
+ * Uploads are recorded and submitted on the transfer queue and signal a
+ * timeline semaphore. The returned ticket is the value that is signaled
+ * once the copy has finished, 0 means the upload failed.
+ *
+ * If the transfer queue belongs to a different family, ownership of the
+ * resource is released by the upload and acquired by the first command
+ * buffer begun after the copy completed. Resources may only be used once
+ * ignisUploadReady returns true for their ticket.
+ *
+ * Data is staged in a persistently mapped ring buffer, payloads bigger
+ * than the ring are split into several submits. Staging space is reused
+ * once the timeline passes the submit that used it.
+ */
+typedef uint64_t IgnisUploadTicket;
+
+uint8_t ignisCreateUploadQueue(VkDeviceSize stagingSize);
+void ignisDestroyUploadQueue();
+
+IgnisUploadTicket ignisUploadBuffer(IgnisBuffer* buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+IgnisUploadTicket ignisUploadTexture(IgnisTexture* texture, const void* pixels);
+
+uint8_t ignisUploadComplete(IgnisUploadTicket ticket); /* copy has finished on the transfer queue */
+uint8_t ignisUploadReady(IgnisUploadTicket ticket);    /* resource is owned by the graphics queue */
+
+void ignisWaitUpload(IgnisUploadTicket ticket);
+
+/*
+ * Uploads issued between ignisBeginUploadBatch and ignisEndUploadBatch
+ * are recorded into a single command buffer with batched barriers and
+ * submitted together. Inside a batch the upload functions return the
+ * ticket the batch will be submitted with, ignisEndUploadBatch returns
+ * the ticket of the whole batch. If the staging ring runs full the
+ * copies recorded so far are submitted early.
+ */
+void ignisBeginUploadBatch();
+IgnisUploadTicket ignisEndUploadBatch();
+
+uint8_t ignisUploadBatching();
+
+/* free resources of finished uploads */
+void ignisCollectUploads();
+
+/* records ownership acquires for completed uploads, returns the timeline value to wait for */
+uint64_t ignisAcquireUploads(VkCommandBuffer commandBuffer);
+VkSemaphore ignisGetUploadSemaphore();
+
+#endif /* !IGNIS_UPLOAD_H */
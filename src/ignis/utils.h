@@ -6,6 +6,7 @@
 #include <vulkan/vulkan.h>
 
 #define IGNIS_VK_PFN(instance, name) ((PFN_##name)vkGetInstanceProcAddr((instance), (#name)))
+#define IGNIS_VK_DEVICE_PFN(device, name) ((PFN_##name)vkGetDeviceProcAddr((device), (#name)))
 
 VkSurfaceFormatKHR ignisChooseSurfaceFormat(VkPhysicalDevice device, VkSurfaceKHR surface);
 VkPresentModeKHR ignisChoosePresentMode(VkPhysicalDevice device, VkSurfaceKHR surface);
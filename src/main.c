@@ -9,6 +9,7 @@
 #include "ignis/pipeline.h"
 #include "ignis/buffer.h"
 #include "ignis/texture.h"
+#include "ignis/upload.h"
 
 #include "font_renderer.h"
 
@@ -71,7 +72,7 @@ uint8_t onLoad(const char* title,  int32_t x, int32_t y, uint32_t w, uint32_t h)
         return MINIMAL_FAIL;
     }
 
-    if (!ignisInit("VulkanApp", w, h, minimalGetNativeWindowHandle(window)))
+    if (!ignisInit("VulkanApp", w, h, minimalGetNativeWindowHandle(window), NULL))
     {
         MINIMAL_CRITICAL("Failed to create ignis context.");
         return MINIMAL_FAIL;
@@ -96,21 +97,13 @@ uint8_t onLoad(const char* title,  int32_t x, int32_t y, uint32_t w, uint32_t h)
         .attributeCount = attributeCount,
         .vertexStride = VERTEX_SIZE,
         .uniformBufferSize = sizeof(UniformBufferObject),
-        .cullMode = VK_CULL_MODE_BACK_BIT,
-        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
     };
 
-    VkShaderModule vertShader = ignisCreateShaderModule("./res/shader/shader.vert.spv");
-    VkShaderModule fragShader = ignisCreateShaderModule("./res/shader/shader.frag.spv");
+    // compiled in the background while the assets are uploaded
+    IgnisPipelineBuild* pipelineBuild = ignisCreatePipelineAsync(&pipelineConfig, "./res/shader/shader.vert.spv", "./res/shader/shader.frag.spv", &pipeline);
 
-    if (!ignisCreatePipeline(&pipelineConfig, vertShader, fragShader, &pipeline))
-    {
-        MINIMAL_CRITICAL("failed to create pipeline");
-        return MINIMAL_FAIL;
-    }
-
-    ignisDestroyShaderModule(vertShader);
-    ignisDestroyShaderModule(fragShader);
+    // record all uploads into one submit
+    ignisBeginUploadBatch();
 
     // create buffer
     if (!ignisCreateVertexBuffer(vertices, vertexCount * VERTEX_SIZE, &vertexBuffer))
@@ -133,6 +126,14 @@ uint8_t onLoad(const char* title,  int32_t x, int32_t y, uint32_t w, uint32_t h)
 
     MINIMAL_INFO("Loaded %d font(s)", fontAtlas.font_count);
 
+    ignisWaitUpload(ignisEndUploadBatch());
+
+    if (!ignisWaitPipeline(pipelineBuild))
+    {
+        MINIMAL_CRITICAL("failed to create pipeline");
+        return MINIMAL_FAIL;
+    }
+
     ignisFontConfigClear(&config, 1);
 
     ignisFontRendererInit();
@@ -147,8 +148,6 @@ uint8_t onLoad(const char* title,  int32_t x, int32_t y, uint32_t w, uint32_t h)
 
 void onDestroy()
 {
-    vkDeviceWaitIdle(ignisGetVkDevice());
-
     ignisFontAtlasClear(&fontAtlas);
     ignisFontRendererDestroy();
 
@@ -203,8 +202,8 @@ void onTick(void* context, const MinimalFrameData* framedata)
         ignisPushUniform(&pipeline, &view, sizeof(mat4), 1 * sizeof(mat4));
         ignisPushUniform(&pipeline, &proj, sizeof(mat4), 2 * sizeof(mat4));
 
-        ignisBindPipeline(commandBuffer, &pipeline);
         ignisBindTexture(&pipeline, &texture, 1);
+        ignisBindPipeline(commandBuffer, &pipeline);
 
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.handle, IGNIS_OFFSET64(0));
 